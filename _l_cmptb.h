@@ -0,0 +1,149 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_cmptb.h
+// Compact state tables for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// When asked the generator emits, in addition to the _l_state<> objects, one contiguous array of compact states and one of
+//  packed transitions for all the DFAs in the generated header. These reference states by index instead of by pointer, so
+//  they hold no addresses and need no relocations. The index is 16bit when the state machine is small enough and 32bit
+//  otherwise - for char this makes a transition 4 or 8 bytes instead of 16. The array of pointers to the _l_state<> objects
+//  and the _l_compact_tables<> object itself do hold addresses - in position independent builds these are relocated at load
+//  time ( into .data.rel.ro ) - but they are touched only to reach the cold data and once to start the analyzer.
+// The _l_state<> objects are still generated - without transitions - and are reached through a parallel array of pointers
+//  indexed by state. They are the cold data: accept actions, trigger function pointers, lookahead vectors and the debugging
+//  state number. Since they have no transitions they can't be used with _l_match<>. The compact state carries everything needed
+//  per character - including a copy of the accept flag - so the analyzer only touches the _l_state<> on accept, on a trigger
+//  and when tracing. A trigger moves to the trigger state's index held in the compact state and the start state's index
+//  comes from the short table of the start states of the DFAs - so the analyzer never searches the states.
+// Every state index stored in the tables - transition targets, default and trigger states - has s_kiAcceptTag set when
+//  the target state accepts ( m_flAccept != 0 ). The analyzer keeps the tag on its current index and so knows whether it
+//  needs to record an accept without loading anything. Methods taking a state index accept tagged or untagged indices.
+
+#include "_l_ns.h"
+#include "_l_types.h"
+#include "_l_chrtr.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+template < class t_TyChar, class t_TyStateIndex >
+struct _l_compact_transition
+{
+  typedef typename _l_char_type_map<t_TyChar>::_TyUnsigned _TyUnsignedChar;
+  _TyUnsignedChar m_first;
+  _TyUnsignedChar m_last;
+  t_TyStateIndex m_iState;
+};
+
+template < class t_TyStateIndex >
+struct _l_compact_state
+{
+  uint32_t m_itFirst; // Index of the first transition of this state in the transition table.
+  vTyNTransitions m_nt;
+  vTyStateFlags m_flAccept; // Copy of _l_state_proto::m_flAccept.
+  t_TyStateIndex m_iStateDefault; // Transition on any character other than eof that isn't matched in the transition table, or s_kiNullState.
+  t_TyStateIndex m_iStateTrigger; // The state moved to on a trigger ( see _l_state_proto::m_pspTrigger ), or s_kiNullState.
+};
+
+template < class t_TyChar, class t_TyStateIndex >
+struct _l_compact_tables
+{
+  typedef t_TyChar _TyChar;
+  typedef t_TyStateIndex _TyStateIndex;
+  typedef typename _l_char_type_map<t_TyChar>::_TyUnsigned _TyUnsignedChar;
+  typedef _l_compact_transition< t_TyChar, t_TyStateIndex > _TyTransition;
+  typedef _l_compact_state< t_TyStateIndex > _TyCompactState;
+  typedef _l_state_proto< t_TyChar > _TyStateProto;
+  static_assert( is_unsigned_v< t_TyStateIndex > );
+
+  static constexpr t_TyStateIndex s_kiNullState = (numeric_limits< t_TyStateIndex >::max)();
+  static constexpr t_TyStateIndex s_kiAcceptTag = t_TyStateIndex( 1 ) << ( CHAR_BIT * sizeof( t_TyStateIndex ) - 1 );
+  static constexpr t_TyStateIndex s_kiStateMask = s_kiAcceptTag - 1; // s_kiNullState's masked value is never a valid state.
+  static constexpr vTyNTransitions s_knLinearSearchMax = 5; // Same as the unrolled cases in _l_analyzer::_getnext().
+
+  const _TyCompactState * m_rgcsStates;
+  const _TyTransition * m_rgctTransitions;
+  const void * const * m_rgpvStates; // The _l_state<> for each index - void since an _l_state<> is only layout compatible with _l_state_proto and the reinterpret_cast can't appear in a constant initializer.
+  size_t m_nStates;
+  const t_TyStateIndex * m_rgiStartStates; // The ( untagged ) index of the start state of each DFA.
+  size_t m_nStartStates;
+
+  static bool FIsAcceptTagged( t_TyStateIndex _iState )
+  {
+    return !!( _iState & s_kiAcceptTag );
+  }
+  static t_TyStateIndex IStateUntag( t_TyStateIndex _iState )
+  {
+    return t_TyStateIndex( _iState & s_kiStateMask );
+  }
+  // Return _iState with the accept tag set appropriately.
+  t_TyStateIndex ITagState( t_TyStateIndex _iState ) const
+  {
+    return !FlGetAccept( _iState ) ? IStateUntag( _iState ) : t_TyStateIndex( _iState | s_kiAcceptTag );
+  }
+  vTyStateFlags FlGetAccept( t_TyStateIndex _iState ) const
+  {
+    Assert( IStateUntag( _iState ) < m_nStates );
+    return m_rgcsStates[ IStateUntag( _iState ) ].m_flAccept;
+  }
+  bool FHasTrigger( t_TyStateIndex _iState ) const
+  {
+    Assert( IStateUntag( _iState ) < m_nStates );
+    return s_kiNullState != m_rgcsStates[ IStateUntag( _iState ) ].m_iStateTrigger;
+  }
+  t_TyStateIndex IStateTrigger( t_TyStateIndex _iState ) const
+  {
+    Assert( IStateUntag( _iState ) < m_nStates );
+    return m_rgcsStates[ IStateUntag( _iState ) ].m_iStateTrigger;
+  }
+  const _TyStateProto * PSPGetState( t_TyStateIndex _iState ) const
+  {
+    Assert( IStateUntag( _iState ) < m_nStates );
+    return static_cast< const _TyStateProto * >( m_rgpvStates[ IStateUntag( _iState ) ] );
+  }
+  // Return the ( untagged ) index of the start state _psp or s_kiNullState if it isn't the start state of one of the DFAs.
+  //  This looks at one entry per DFA and is only needed when the analyzer is given a start state it hasn't seen before.
+  t_TyStateIndex IStateFindStart( const _TyStateProto * _psp ) const
+  {
+    for ( size_t stStart = 0; stStart < m_nStartStates; ++stStart )
+    {
+      if ( m_rgpvStates[ m_rgiStartStates[ stStart ] ] == _psp )
+        return m_rgiStartStates[ stStart ];
+    }
+    return s_kiNullState;
+  }
+  // Return the ( tagged ) state reached from _iState on _uc or s_kiNullState if there is no such transition.
+  // _ucEof is the analyzer's eof symbol - 0 unless the analyzer treats 0 as a character ( see _l_analyzer<> ).
+  template < class t_TyScanChar >
+  t_TyStateIndex IStateNext( t_TyStateIndex _iState, t_TyScanChar _uc, t_TyScanChar _ucEof ) const
+  {
+    Assert( IStateUntag( _iState ) < m_nStates );
+    const _TyCompactState & rcs = m_rgcsStates[ IStateUntag( _iState ) ];
+    const _TyTransition * ptCur = m_rgctTransitions + rcs.m_itFirst;
+    const _TyTransition * const ptEnd = ptCur + rcs.m_nt;
+    if ( rcs.m_nt <= s_knLinearSearchMax )
+    {
+      for ( ; ptEnd != ptCur; ++ptCur )
+      {
+        if ( ( _uc <= ptCur->m_last ) && ( _uc >= ptCur->m_first ) )
+          return ptCur->m_iState;
+      }
+    }
+    else
+    {
+      const _TyTransition * ptLwr = lower_bound( ptCur, ptEnd, _uc,
+        []( _TyTransition const & _rt, t_TyScanChar _ucSearch ) { return _rt.m_last < _ucSearch; } );
+      if ( ( ptEnd != ptLwr ) && ( _uc >= ptLwr->m_first ) )
+        return ptLwr->m_iState;
+    }
+    return ( _ucEof != _uc ) ? rcs.m_iStateDefault : s_kiNullState; // The default transition never applies to eof.
+  }
+};
+
+__LEXOBJ_END_NAMESPACE
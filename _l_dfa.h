@@ -29,6 +29,15 @@ public:
   }
 };
 
+// Orderings for _dfa_context::ReorderStates().
+enum EDfaStateOrder
+{
+	edsoConstruction, // Leave states in the order resulting from construction/optimization.
+	edsoWeightedBreadthFirst, // Breadth first from the start state, visiting likelier ( wider range ) successors first.
+	edsoReversePostOrder, // Reverse post-order of a depth first walk from the start state - likelier successors follow their predecessor.
+	edsoDfaStateOrderCount // This at the end always.
+};
+
 template < class t_TyChar, class t_TyAllocator >
 class _dfa_context;
 
@@ -65,6 +74,8 @@ public:
 	friend struct _create_dfa;
 	template < class t_TyDfa, bool f_tPartDeadImmed >
 	friend struct _optimize_dfa;
+	template < class t__TyNfa, class t__TyDfa >
+	friend class _dfa_cache;
 	friend class _dfa_context< t_TyChar, t_TyAllocator >;
 	
 	typedef t_TyAllocator _TyAllocator;
@@ -1088,6 +1099,180 @@ public:
 		Assert( RDfa().m_nodeLookup.size() == m_pssAccept->size() );
 	}
 
+	// Renumber the states for locality of reference - the generator emits states in state number order so we want likely
+	//	successors to be near their predecessors. The likelihood of a transition is estimated by the number of characters it covers.
+	// Call after optimization and ProcessUnsatisfiableTranstitions() since they assume the root is state 0. The start state
+	//	is always renumbered to 0 ( or 1 if there is still a dead state - which remains at 0 ).
+	void	ReorderStates( EDfaStateOrder _edso )
+	{
+		if ( ( edsoConstruction == _edso ) || ( RDfa().NStates() < 2 ) )
+			return;
+		Assert( !!m_pgnStart );
+		RDfa()._CreateRangeLookup();
+
+		size_t nStates = (size_t)RDfa().NStates();
+		vector< _TyState > rgOrder;
+		rgOrder.reserve( nStates );
+		_TySetStates	ssVisited( nStates, RDfa().get_allocator() );
+		ssVisited.clear();
+		if ( RDfa().m_fHasDeadState )
+		{
+			rgOrder.push_back( 0 );
+			ssVisited.setbit( 0 );
+		}
+
+		typedef vector< pair< uint64_t, _TyGraphNode * > > _TyRgWeightedChildren;
+		if ( edsoWeightedBreadthFirst == _edso )
+		{
+			_TyRgWeightedChildren rgChildren;
+			rgOrder.push_back( m_pgnStart->RElConst() );
+			ssVisited.setbit( (size_t)m_pgnStart->RElConst() );
+			for ( size_t stCur = rgOrder.size() - 1; stCur < rgOrder.size(); ++stCur )
+			{
+				_GetWeightedChildren( RDfa().PGNGetNode( rgOrder[ stCur ] ), rgChildren );
+				for ( typename _TyRgWeightedChildren::const_reverse_iterator rit = rgChildren.rbegin(); rgChildren.rend() != rit; ++rit )
+				{
+					size_t stChild = (size_t)rit->second->RElConst();
+					if ( !ssVisited.isbitset( stChild ) )
+					{
+						ssVisited.setbit( stChild );
+						rgOrder.push_back( (_TyState)stChild );
+					}
+				}
+			}
+		}
+		else
+		{
+			Assert( edsoReversePostOrder == _edso );
+			// Iterative depth first walk - children are visited lightest first so that the heaviest ends up immediately after its parent:
+			vector< pair< _TyRgWeightedChildren, size_t > > rgStack;
+			vector< _TyState > rgPostOrder;
+			rgPostOrder.reserve( nStates );
+			ssVisited.setbit( (size_t)m_pgnStart->RElConst() );
+			rgStack.emplace_back();
+			_GetWeightedChildren( m_pgnStart, rgStack.back().first );
+			vector< _TyState > rgNodeStack( 1, m_pgnStart->RElConst() );
+			while ( !rgStack.empty() )
+			{
+				pair< _TyRgWeightedChildren, size_t > & rprTop = rgStack.back();
+				if ( rprTop.second == rprTop.first.size() )
+				{
+					rgPostOrder.push_back( rgNodeStack.back() );
+					rgNodeStack.pop_back();
+					rgStack.pop_back();
+					continue;
+				}
+				_TyGraphNode * pgnChild = rprTop.first[ rprTop.second++ ].second;
+				if ( !ssVisited.isbitset( (size_t)pgnChild->RElConst() ) )
+				{
+					ssVisited.setbit( (size_t)pgnChild->RElConst() );
+					rgNodeStack.push_back( pgnChild->RElConst() );
+					rgStack.emplace_back();
+					_GetWeightedChildren( pgnChild, rgStack.back().first ); // invalidates rprTop.
+				}
+			}
+			rgOrder.insert( rgOrder.end(), rgPostOrder.rbegin(), rgPostOrder.rend() );
+		}
+		// Any states not reachable from the start state retain their relative order at the end:
+		for ( size_t stState = 0; stState < nStates; ++stState )
+		{
+			if ( !ssVisited.isbitset( stState ) )
+				rgOrder.push_back( (_TyState)stState );
+		}
+		Assert( rgOrder.size() == nStates );
+
+		vector< _TyState > rgNewFromOld( nStates );
+		bool fIdentity = true;
+		for ( size_t stNew = 0; stNew < nStates; ++stNew )
+		{
+			rgNewFromOld[ (size_t)rgOrder[ stNew ] ] = (_TyState)stNew;
+			fIdentity = fIdentity && ( rgOrder[ stNew ] == (_TyState)stNew );
+		}
+		if ( fIdentity )
+			return;
+
+		// Renumber the nodes and the node lookup:
+		typename _TyDfa::_TyNodeLookup nodeLookupNew( RDfa().m_nodeLookup.get_allocator() );
+		nodeLookupNew.resize( nStates );
+		for ( size_t stNew = 0; stNew < nStates; ++stNew )
+			nodeLookupNew[ stNew ] = RDfa().m_nodeLookup[ (size_t)rgOrder[ stNew ] ];
+		RDfa().m_nodeLookup.swap( nodeLookupNew );
+		for ( size_t stNew = 0; stNew < nStates; ++stNew )
+			RDfa().PGNGetNode( (_TyState)stNew )->RElNonConst() = (_TyState)stNew;
+
+		// Renumber the accepting states and the accept partition:
+		bool fHadPartLookup = !!m_pPartLookup;
+		if ( fHadPartLookup )
+			DeallocAcceptPartLookup();
+		_TySetStates	ssNewAccept( nStates, RDfa().get_allocator() );
+		_RenumberStates( *m_pssAccept, ssNewAccept, rgNewFromOld );
+		m_pssAccept->swap( ssNewAccept );
+
+		_TyPartAcceptStates	partAcceptNew( _TyCompareStates(), RDfa().get_allocator() );
+		typename _TyPartAcceptStates::iterator	itPartEnd = m_partAccept.end();
+		for ( typename _TyPartAcceptStates::iterator	itPart = m_partAccept.begin(); itPart != itPartEnd; ++itPart )
+		{
+			_TySetStates	ssPartNew( nStates, RDfa().get_allocator() );
+			_RenumberStates( itPart->first.RObject(), ssPartNew, rgNewFromOld );
+			typename _TyPartAcceptStates::value_type	vt( ssPartNew, itPart->second );
+#if ASSERTSENABLED
+			pair< typename _TyPartAcceptStates::iterator, bool >	pib =
+#endif //ASSERTSENABLED
+			partAcceptNew.insert( vt );
+			Assert( pib.second );
+		}
+		m_partAccept.swap( partAcceptNew );
+		if ( fHadPartLookup )
+			CreateAcceptPartLookup();
+
+		RDfa()._ClearSSCache();	// Cached state sets may refer to the old numbering.
+	}
+
+	// Return the distinct children of _pgn sorted by increasing estimated likelihood. Ties go to the higher state number
+	//	so that iteration from the back is deterministic and favors lower numbered states.
+	void	_GetWeightedChildren( _TyGraphNode * _pgn, vector< pair< uint64_t, _TyGraphNode * > > & _rrgChildren ) const
+	{
+		_rrgChildren.clear();
+		typename _TyDfa::_TyAlphaIndex aiLastSatisfiable = RDfa().AIGetLastSatisfiable();
+		for ( typename _TyGraph::_TyLinkPosIterConst lpi( _pgn->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+		{
+			uint64_t u64Weight = 0; // Triggers and unsatisfiable transitions don't consume input.
+			if ( *lpi <= aiLastSatisfiable )
+			{
+				typename _TyDfa::_TyRange rng = RDfa().LookupRange( *lpi );
+				u64Weight = uint64_t( rng.second ) - uint64_t( rng.first ) + 1;
+			}
+			_rrgChildren.push_back( make_pair( u64Weight, lpi.PGNChild() ) );
+		}
+		// Merge the weights of links to the same child:
+		sort( _rrgChildren.begin(), _rrgChildren.end(), 
+			[]( pair< uint64_t, _TyGraphNode * > const & _rl, pair< uint64_t, _TyGraphNode * > const & _rr )
+			{
+				return _rl.second->RElConst() < _rr.second->RElConst();
+			} );
+		size_t stOut = 0;
+		for ( size_t stIn = 0; stIn < _rrgChildren.size(); ++stIn )
+		{
+			if ( stOut && ( _rrgChildren[ stOut - 1 ].second == _rrgChildren[ stIn ].second ) )
+				_rrgChildren[ stOut - 1 ].first += _rrgChildren[ stIn ].first;
+			else
+				_rrgChildren[ stOut++ ] = _rrgChildren[ stIn ];
+		}
+		_rrgChildren.resize( stOut );
+		sort( _rrgChildren.begin(), _rrgChildren.end(), 
+			[]( pair< uint64_t, _TyGraphNode * > const & _rl, pair< uint64_t, _TyGraphNode * > const & _rr )
+			{
+				return ( _rl.first < _rr.first ) || ( ( _rl.first == _rr.first ) && ( _rl.second->RElConst() > _rr.second->RElConst() ) );
+			} );
+	}
+
+	static void	_RenumberStates( _TySetStates const & _rssOld, _TySetStates & _rssNew, vector< _TyState > const & _rrgNewFromOld )
+	{
+		_rssNew.clear();
+		for ( typename _TySetStates::size_type stOld = _rssOld.getfirstset(); _rssOld.size() != stOld; stOld = _rssOld.getnextset( stOld ) )
+			_rssNew.setbit( (size_t)_rrgNewFromOld[ stOld ] );
+	}
+
 	// Compress accept paritions that correspond to the same trigger actions.
 	// This allows the optimizer to generate more optimal DFA's - since these
 	//	states have no reason ( after disambiguation ) to have differring action
@@ -0,0 +1,341 @@
+#ifndef __L_DFABK_H
+#define __L_DFABK_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_dfabk.h
+
+// Static worst-case backtracking analysis of an optimized DFA.
+// The analyzer finds the longest match: after it passes an accepting state it keeps reading until the DFA has no transition and
+//	then backs up to m_posLastAccept. The next token starts from there, so everything read past the accept is read again. If,
+//	after some accepting state, the DFA can go round a cycle of non-accepting states then the amount re-read is bounded only by
+//	the input and a sequence of such tokens is quadratic in the input length.
+// For each accepting state we find the non-accepting states reachable from it without passing through another accepting state -
+//	the continuations that may fail and be re-read. If these contain a cycle the re-read is unbounded, otherwise we report the
+//	longest such continuation in characters ( the character that fails is read in addition to these ). The rules responsible are
+//	the rule accepted by the state and the rules whose accepting states the continuations lead to - the longer matches that are
+//	being tried for.
+// Usage:
+//	_dfa_backtrack_analysis< _TyDfa > dba( dfaCtxt );
+//	dba.Analyze();
+//	if ( dba.FBacktrackProne() )
+//		dba.Dump( cerr );
+
+__REGEXP_BEGIN_NAMESPACE
+
+template < class t_TyDfa >
+class _dfa_backtrack_analysis
+{
+private:
+  typedef _dfa_backtrack_analysis< t_TyDfa > _TyThis;
+
+public:
+  typedef t_TyDfa _TyDfa;
+  typedef typename _TyDfa::_TyContext _TyDfaCtxt;
+  typedef typename _TyDfa::_TyState _TyState;
+  typedef typename _TyDfa::_TyAlphaIndex _TyAlphaIndex;
+  typedef typename _TyDfa::_TyGraph _TyGraph;
+  typedef typename _TyDfa::_TyGraphNode _TyGraphNode;
+  typedef typename _TyDfa::_TyAcceptAction _TyAcceptAction;
+  typedef typename _TyDfaCtxt::_TyPartAcceptStates _TyPartAcceptStates;
+
+  static constexpr size_t s_knUnbounded = (numeric_limits< size_t >::max)();
+
+  // A rule is identified by its action id and, if it has an action object, its token id.
+  struct _rule
+  {
+    vtyActionIdent m_aiAction{0};
+    vtyTokenIdent m_tidToken{vktidInvalidIdToken};
+    bool operator < ( _rule const & _r ) const
+    {
+      return ( m_aiAction < _r.m_aiAction ) || ( ( m_aiAction == _r.m_aiAction ) && ( m_tidToken < _r.m_tidToken ) );
+    }
+    bool operator == ( _rule const & _r ) const
+    {
+      return ( m_aiAction == _r.m_aiAction ) && ( m_tidToken == _r.m_tidToken );
+    }
+  };
+  // The result for a single accepting state.
+  struct _accept_backtrack
+  {
+    _TyState m_iState{0};
+    _rule m_ruleAccept;
+    size_t m_nMaxReread{0}; // s_knUnbounded if a non-accepting cycle is reachable.
+    _TyState m_iStateCycle{0}; // If unbounded: a state on such a cycle.
+    vector< _rule > m_rgruleContinuing; // The rules accepted by the states the continuations lead to - sorted.
+    bool FUnbounded() const
+    {
+      return s_knUnbounded == m_nMaxReread;
+    }
+  };
+
+protected:
+  _TyDfaCtxt & m_rDfaCtxt;
+  typename _TyDfa::_TyPrAI m_praiTriggers;
+  vector< _accept_backtrack > m_rgabStates; // Accepting states with any continuations, in state order.
+  size_t m_nMaxReread{0};
+
+  // Per state results for the non-accepting states:
+  static constexpr size_t s_knUnvisited = s_knUnbounded - 1;
+  static constexpr size_t s_knOnStack = s_knUnbounded - 2;
+  vector< size_t > m_rgnLongest; // Longest continuation starting at the state, in characters.
+  vector< _TyState > m_rgiStateCycle; // For states that reach a cycle: a state on the cycle.
+
+public:
+  _dfa_backtrack_analysis( _TyDfaCtxt & _rDfaCtxt )
+    : m_rDfaCtxt( _rDfaCtxt )
+  {
+  }
+
+  _TyDfa & RDfa() const { return m_rDfaCtxt.RDfa(); }
+  vector< _accept_backtrack > const & RGetResults() const { return m_rgabStates; }
+  // The longest re-read after any accept - s_knUnbounded if any is unbounded.
+  size_t NMaxReread() const { return m_nMaxReread; }
+  bool FBacktrackProne() const { return s_knUnbounded == m_nMaxReread; }
+
+  void Analyze()
+  {
+    m_rgabStates.clear();
+    m_nMaxReread = 0;
+    RDfa().GetTriggerUnsatAIRanges( &m_praiTriggers, nullptr );
+    bool fCreatedLookup = !m_rDfaCtxt.m_pPartLookup;
+    if ( fCreatedLookup )
+      m_rDfaCtxt.CreateAcceptPartLookup();
+    _TyState nStates = RDfa().NStates();
+    m_rgnLongest.assign( (size_t)nStates, s_knUnvisited );
+    m_rgiStateCycle.assign( (size_t)nStates, 0 );
+    for ( _TyState iState = 0; iState < nStates; ++iState )
+    {
+      _TyGraphNode * pgn = RDfa().PGNGetNode( iState );
+      if ( !pgn || !_FIsAccepting( pgn ) )
+        continue;
+      _accept_backtrack ab;
+      ab.m_iState = iState;
+      ab.m_ruleAccept = _RuleGet( pgn );
+      for ( typename _TyGraph::_TyLinkPosIterConst lpi( pgn->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+      {
+        _TyGraphNode * pgnChild = lpi.PGNChild();
+        if ( _FIsAccepting( pgnChild ) )
+          continue;
+        size_t nLongest = _NLongest( pgnChild );
+        if ( s_knUnbounded == nLongest )
+        {
+          if ( !ab.FUnbounded() )
+            ab.m_iStateCycle = m_rgiStateCycle[ (size_t)pgnChild->RElConst() ];
+          ab.m_nMaxReread = s_knUnbounded;
+        }
+        else
+        if ( !ab.FUnbounded() )
+          ab.m_nMaxReread = (std::max)( ab.m_nMaxReread, nLongest + _NWeight( *lpi ) );
+      }
+      if ( !ab.m_nMaxReread )
+        continue; // Every transition leads to an accepting state - nothing is re-read.
+      _GetContinuingRules( pgn, ab.m_rgruleContinuing );
+      m_nMaxReread = ab.FUnbounded() ? s_knUnbounded : ( FBacktrackProne() ? m_nMaxReread : (std::max)( m_nMaxReread, ab.m_nMaxReread ) );
+      m_rgabStates.push_back( std::move( ab ) );
+    }
+    if ( fCreatedLookup )
+      m_rDfaCtxt.DeallocAcceptPartLookup();
+  }
+
+  void Dump( ostream & _ros ) const
+  {
+    for ( _accept_backtrack const & rab : m_rgabStates )
+    {
+      _ros << "Accept state [" << rab.m_iState << "] rule ";
+      _DumpRule( _ros, rab.m_ruleAccept );
+      if ( rab.FUnbounded() )
+        _ros << ": unbounded re-read through non-accepting cycle at state [" << rab.m_iStateCycle << "]";
+      else
+        _ros << ": re-read up to [" << rab.m_nMaxReread << "] characters";
+      _ros << "; continuing rules:";
+      for ( _rule const & rrule : rab.m_rgruleContinuing )
+      {
+        _ros << " ";
+        _DumpRule( _ros, rrule );
+      }
+      _ros << "\n";
+    }
+  }
+
+  // Return the results as an n_SysLog JSON value.
+  n_SysLog::vtyJsoValueSysLog GetJsonValue() const
+  {
+    n_SysLog::vtyJsoValueSysLog jv(ejvtObject);
+    jv("BacktrackProne").SetValue( FBacktrackProne() );
+    if ( !FBacktrackProne() )
+      jv("MaxReread").SetValue( m_nMaxReread );
+    n_SysLog::vtyJsoValueSysLog & jvStates = jv("AcceptStates");
+    for ( size_t stResult = 0; stResult < m_rgabStates.size(); ++stResult )
+    {
+      _accept_backtrack const & rab = m_rgabStates[ stResult ];
+      n_SysLog::vtyJsoValueSysLog jvState(ejvtObject);
+      jvState("State").SetValue( rab.m_iState );
+      jvState("Rule") = _JvRule( rab.m_ruleAccept );
+      jvState("Unbounded").SetValue( rab.FUnbounded() );
+      if ( rab.FUnbounded() )
+        jvState("CycleState").SetValue( rab.m_iStateCycle );
+      else
+        jvState("MaxReread").SetValue( rab.m_nMaxReread );
+      n_SysLog::vtyJsoValueSysLog & jvRules = jvState("ContinuingRules");
+      for ( size_t stRule = 0; stRule < rab.m_rgruleContinuing.size(); ++stRule )
+        jvRules( stRule ) = _JvRule( rab.m_rgruleContinuing[ stRule ] );
+      jvStates( stResult ) = jvState;
+    }
+    return jv;
+  }
+
+protected:
+  bool _FIsAccepting( _TyGraphNode * _pgn ) const
+  {
+    if ( !m_rDfaCtxt.m_pssAccept->isbitset( (size_t)_pgn->RElConst() ) )
+      return false;
+    // Pure lookahead and anti-accepting states don't record a position to back up to:
+    const typename _TyPartAcceptStates::value_type * pvtAction = m_rDfaCtxt.PVTGetAcceptPart( _pgn->RElConst() );
+    Assert( !!pvtAction );
+    const unsigned kuType = pvtAction->second.m_eaatType & ~e_aatTrigger;
+    return ( e_aatLookahead != kuType ) && ( e_aatAntiAccepting != kuType ) && ( e_aatNone != kuType );
+  }
+  _rule _RuleGet( _TyGraphNode * _pgn ) const
+  {
+    const typename _TyPartAcceptStates::value_type * pvtAction = m_rDfaCtxt.PVTGetAcceptPart( _pgn->RElConst() );
+    Assert( !!pvtAction );
+    _rule rule;
+    rule.m_aiAction = pvtAction->second.m_aiAction;
+    if ( !!pvtAction->second.m_pSdpAction )
+      rule.m_tidToken = (*pvtAction->second.m_pSdpAction)->VGetTokenId();
+    return rule;
+  }
+  // Trigger transitions don't consume a character.
+  size_t _NWeight( _TyAlphaIndex _ai ) const
+  {
+    return ( ( _ai >= m_praiTriggers.first ) && ( _ai < m_praiTriggers.second ) ) ? 0 : 1;
+  }
+  // Return the longest run of characters that can be read starting at the non-accepting state _pgn before entering an accepting
+  //	state or failing - s_knUnbounded if a cycle of non-accepting states is reachable. This is a depth first search over the
+  //	non-accepting states: meeting a state that is still on the stack closes a cycle. Results are cached for all states.
+  size_t _NLongest( _TyGraphNode * _pgnRoot )
+  {
+    typedef typename _TyGraph::_TyLinkPosIterConst _TyLPI;
+    size_t & rnRoot = m_rgnLongest[ (size_t)_pgnRoot->RElConst() ];
+    if ( ( s_knUnvisited != rnRoot ) && ( s_knOnStack != rnRoot ) )
+      return rnRoot;
+    vector< pair< _TyGraphNode *, _TyLPI > > rgStack;
+    rnRoot = s_knOnStack;
+    rgStack.emplace_back( _pgnRoot, _TyLPI( _pgnRoot->PPGLChildHead() ) );
+    size_t nLongestChild = 0; // The result of the child just finished.
+    while ( !rgStack.empty() )
+    {
+      _TyGraphNode * pgnCur = rgStack.back().first;
+      _TyLPI & rlpi = rgStack.back().second;
+      size_t & rnCur = m_rgnLongest[ (size_t)pgnCur->RElConst() ];
+      if ( rlpi.FIsLast() )
+      {
+        if ( s_knOnStack == rnCur )
+          rnCur = 0;
+        nLongestChild = rnCur;
+        rgStack.pop_back();
+        if ( !rgStack.empty() )
+          _MergeChild( rgStack.back().first, *rgStack.back().second, pgnCur, nLongestChild );
+        if ( !rgStack.empty() )
+          rgStack.back().second.NextChild();
+        continue;
+      }
+      _TyGraphNode * pgnChild = rlpi.PGNChild();
+      if ( _FIsAccepting( pgnChild ) )
+      {
+        // Reading up to an accept isn't re-read - but the accept's own continuations are accounted to it.
+        rlpi.NextChild();
+        continue;
+      }
+      size_t & rnChild = m_rgnLongest[ (size_t)pgnChild->RElConst() ];
+      if ( s_knUnvisited == rnChild )
+      {
+        rnChild = s_knOnStack;
+        rgStack.emplace_back( pgnChild, _TyLPI( pgnChild->PPGLChildHead() ) );
+        continue;
+      }
+      if ( s_knOnStack == rnChild )
+      {
+        // A cycle - every state on the stack reaches it:
+        m_rgiStateCycle[ (size_t)pgnChild->RElConst() ] = pgnChild->RElConst();
+        _MergeChild( pgnCur, *rlpi, pgnChild, s_knUnbounded );
+      }
+      else
+        _MergeChild( pgnCur, *rlpi, pgnChild, rnChild );
+      rlpi.NextChild();
+    }
+    return rnRoot;
+  }
+  void _MergeChild( _TyGraphNode * _pgnParent, _TyAlphaIndex _ai, _TyGraphNode * _pgnChild, size_t _nChild )
+  {
+    size_t & rnParent = m_rgnLongest[ (size_t)_pgnParent->RElConst() ];
+    if ( s_knUnbounded == rnParent )
+      return;
+    if ( s_knUnbounded == _nChild )
+    {
+      rnParent = s_knUnbounded;
+      m_rgiStateCycle[ (size_t)_pgnParent->RElConst() ] = m_rgiStateCycle[ (size_t)_pgnChild->RElConst() ];
+      return;
+    }
+    size_t nThrough = _nChild + _NWeight( _ai );
+    if ( ( s_knOnStack == rnParent ) || ( rnParent < nThrough ) )
+      rnParent = nThrough;
+  }
+  // The rules accepted at the end of the non-accepting continuations of the accepting state _pgnAccept.
+  void _GetContinuingRules( _TyGraphNode * _pgnAccept, vector< _rule > & _rrgrule ) const
+  {
+    _rrgrule.clear();
+    vector< bool > rgfVisited( (size_t)RDfa().NStates(), false );
+    vector< _TyGraphNode * > rgpgnStack;
+    for ( typename _TyGraph::_TyLinkPosIterConst lpi( _pgnAccept->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+    {
+      _TyGraphNode * pgnChild = lpi.PGNChild();
+      if ( !_FIsAccepting( pgnChild ) && !rgfVisited[ (size_t)pgnChild->RElConst() ] )
+      {
+        rgfVisited[ (size_t)pgnChild->RElConst() ] = true;
+        rgpgnStack.push_back( pgnChild );
+      }
+    }
+    while ( !rgpgnStack.empty() )
+    {
+      _TyGraphNode * pgnCur = rgpgnStack.back();
+      rgpgnStack.pop_back();
+      for ( typename _TyGraph::_TyLinkPosIterConst lpi( pgnCur->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+      {
+        _TyGraphNode * pgnChild = lpi.PGNChild();
+        if ( rgfVisited[ (size_t)pgnChild->RElConst() ] )
+          continue;
+        rgfVisited[ (size_t)pgnChild->RElConst() ] = true;
+        if ( _FIsAccepting( pgnChild ) )
+          _rrgrule.push_back( _RuleGet( pgnChild ) );
+        else
+          rgpgnStack.push_back( pgnChild );
+      }
+    }
+    sort( _rrgrule.begin(), _rrgrule.end() );
+    _rrgrule.erase( unique( _rrgrule.begin(), _rrgrule.end() ), _rrgrule.end() );
+  }
+  static void _DumpRule( ostream & _ros, _rule const & _rrule )
+  {
+    _ros << "[" << _rrule.m_aiAction;
+    if ( vktidInvalidIdToken != _rrule.m_tidToken )
+      _ros << ":" << _rrule.m_tidToken;
+    _ros << "]";
+  }
+  static n_SysLog::vtyJsoValueSysLog _JvRule( _rule const & _rrule )
+  {
+    n_SysLog::vtyJsoValueSysLog jv(ejvtObject);
+    jv("Action").SetValue( _rrule.m_aiAction );
+    if ( vktidInvalidIdToken != _rrule.m_tidToken )
+      jv("Token").SetValue( _rrule.m_tidToken );
+    return jv;
+  }
+};
+
+__REGEXP_END_NAMESPACE
+
+#endif //__L_DFABK_H
@@ -0,0 +1,614 @@
+#ifndef __L_DFACH_H
+#define __L_DFACH_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_dfach.h
+
+// On-disk cache of optimized DFAs.
+// The key is a structural fingerprint of the NFA built from a rule set. NFA construction is cheap and deterministic - it is the
+//	DFA creation and optimization that is expensive - so the fingerprint is computed from the NFA's graph, alphabet, accept states,
+//	action types and token ids, the character type, and any options the caller passes in.
+// Usage - in place of _create_dfa(...).create() and _optimize_dfa(...).optimize():
+//	_dfa_cache< _TyNfa, _TyDfa > dc( "cachedir", grfOptions );
+//	dc.FLoadOrCreate( nfa, nfaCtxt, dfa, dfaCtxt );
+// FLoadOrCreate() is ComputeFingerprint(), FLoad() and, on a miss, creation, optimization and FSave() - these may also be
+//	called individually.
+// _l_generator<>::add_dfa() has an overload that takes the NFA and goes through FLoadOrCreate() with the generator's m_sDfaCacheDir -
+//	the fingerprints are then also written to the generated header so that an unchanged header isn't rewritten.
+// Action objects aren't serialized - on load they are taken from the NFA by action id, which is stable for a given fingerprint.
+
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+__REGEXP_BEGIN_NAMESPACE
+
+template < class t_TyNfa, class t_TyDfa >
+class _dfa_cache
+{
+private:
+  typedef _dfa_cache< t_TyNfa, t_TyDfa > _TyThis;
+
+public:
+  typedef t_TyNfa _TyNfa;
+  typedef typename _TyNfa::_TyContext _TyNfaCtxt;
+  typedef t_TyDfa _TyDfa;
+  typedef typename _TyDfa::_TyContext _TyDfaCtxt;
+  typedef typename _TyDfa::_TyChar _TyChar;
+  typedef typename _TyDfa::_TyState _TyState;
+  typedef typename _TyDfa::_TyRange _TyRange;
+  typedef typename _TyDfa::_TyRangeEl _TyRangeEl;
+  typedef typename _TyDfa::_TyAlphaIndex _TyAlphaIndex;
+  typedef typename _TyDfa::_TySetStates _TySetStates;
+  typedef typename _TyDfa::_TyAcceptAction _TyAcceptAction;
+  typedef typename _TyAcceptAction::_TySetActionIds _TySetActionIds;
+  typedef typename _TyDfa::_TyGraph _TyGraphDfa;
+  typedef typename _TyDfa::_TyGraphNode _TyGraphNodeDfa;
+  typedef typename _TyNfa::_TyGraph _TyGraphNfa;
+  typedef typename _TyNfa::_TyGraphNode _TyGraphNodeNfa;
+
+  static constexpr uint32_t s_ku32Magic = 0x4344584c; // "LXDC"
+  static constexpr uint32_t s_ku32Version = 1;
+
+protected:
+  std::filesystem::path m_pathCacheDir;
+  uint64_t m_u64Options;
+  uint64_t m_u64Fingerprint{0};
+  bool m_fHaveFingerprint{false};
+
+public:
+  // _u64Options: Any options that affect the resultant DFA (creation options, dead state, etc) - these are included in the fingerprint.
+  _dfa_cache( const char * _pszCacheDir, uint64_t _u64Options = 0 )
+    : m_pathCacheDir( _pszCacheDir ),
+      m_u64Options( _u64Options )
+  {
+  }
+
+  uint64_t U64Fingerprint() const
+  {
+    Assert( m_fHaveFingerprint );
+    return m_u64Fingerprint;
+  }
+  std::filesystem::path PathCacheFile() const
+  {
+    Assert( m_fHaveFingerprint );
+    string strName;
+    PrintfStdStr( strName, "%016llx.lxdfa", (unsigned long long)m_u64Fingerprint );
+    return m_pathCacheDir / strName;
+  }
+
+  // Compute the fingerprint of the rule set from its NFA - this must be done before FLoad() and FSave().
+  void ComputeFingerprint( _TyNfa & _rNfa, _TyNfaCtxt & _rNfaCtxt )
+  {
+    _fingerprint fp;
+    fp.Add( s_ku32Version );
+    fp.Add( m_u64Options );
+    fp.Add( sizeof( _TyChar ) );
+    fp.AddString( typeid( _TyChar ).name() );
+    fp.Add( _rNfa.NStates() );
+    fp.Add( _rNfaCtxt.m_pgnStart->RElConst() );
+    fp.Add( _rNfa.m_nTriggers );
+    fp.Add( _rNfa.m_nUnsatisfiableTransitions );
+    fp.Add( _rNfa.m_fHasLookaheads );
+    fp.Add( _rNfa.m_grfNFACreationOptions );
+    fp.Add( _rNfa.m_setAlphabet.size() );
+    for ( typename _TyNfa::_TyAlphabet::const_iterator itAlpha = _rNfa.m_setAlphabet.begin(); _rNfa.m_setAlphabet.end() != itAlpha; ++itAlpha )
+    {
+      fp.Add( itAlpha->first );
+      fp.Add( itAlpha->second );
+    }
+    for ( _TyState nState = 0; nState < _rNfa.NStates(); ++nState )
+    {
+      _TyGraphNodeNfa * pgn = _rNfa.PGNGetNode( nState );
+      fp.Add( pgn->RElConst() );
+      for ( typename _TyGraphNfa::_TyLinkPosIterConst lpi( pgn->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+      {
+        fp.Add( (*lpi).first );
+        fp.Add( (*lpi).second );
+        fp.Add( lpi.PGNChild()->RElConst() );
+      }
+      fp.Add( _TyState( -1 ) ); // terminate the link list.
+    }
+    _TySetStates ssAccepting( (size_t)_rNfa.NStates(), _rNfa.get_allocator() );
+    ssAccepting.clear();
+    _rNfaCtxt.GetAcceptingNodeSet( ssAccepting );
+    fp.Add( _rNfa.m_pSetAcceptStates->size() );
+    for ( typename _TyNfa::_TySetAcceptStates::const_iterator itAccept = _rNfa.m_pSetAcceptStates->begin(); _rNfa.m_pSetAcceptStates->end() != itAccept; ++itAccept )
+    {
+      fp.Add( itAccept->first );
+      fp.Add( ssAccepting.isbitset( (size_t)itAccept->first ) );
+      _AddAcceptAction( fp, itAccept->second );
+    }
+    for ( typename _TyNfa::_TyMapTokenIdToTriggerTransition::const_iterator itTrigger = _rNfa.m_mapTokenIdToTriggerTransition.begin();
+          _rNfa.m_mapTokenIdToTriggerTransition.end() != itTrigger; ++itTrigger )
+    {
+      fp.Add( itTrigger->first );
+      fp.Add( itTrigger->second );
+    }
+    m_u64Fingerprint = fp.U64Get();
+    m_fHaveFingerprint = true;
+  }
+
+  // Load the optimized DFA for _rNfa from the cache or create and optimize it and then save it to the cache.
+  // Returns true if the DFA came from the cache. _fCreateDeadState should be reflected in the options passed to the constructor.
+  bool FLoadOrCreate( _TyNfa & _rNfa, _TyNfaCtxt & _rNfaCtxt, _TyDfa & _rDfa, _TyDfaCtxt & _rDfaCtxt, bool _fCreateDeadState = true, size_t _nThreads = 1 )
+  {
+    ComputeFingerprint( _rNfa, _rNfaCtxt );
+    if ( FLoad( _rNfa, _rDfa, _rDfaCtxt ) )
+      return true;
+    {//B
+      _create_dfa< _TyNfa, _TyDfa > cdfa( _rNfa, _rNfaCtxt, _rDfa, _rDfaCtxt, _fCreateDeadState, 3000, _nThreads );
+      VerifyThrowSz( cdfa.create(), "_dfa_cache::FLoadOrCreate(): DFA creation failed." );
+    }//EB
+    {//B
+      _optimize_dfa< _TyDfa > odfa( _rDfa, _rDfaCtxt, _nThreads );
+      (void)odfa.optimize();
+    }//EB
+    (void)FSave( _rNfa, _rDfa, _rDfaCtxt );
+    return false;
+  }
+
+  // Load the DFA for the current fingerprint into the empty _rDfa/_rDfaCtxt.
+  // Returns false if there is no cache entry or if it is unusable - in which case _rDfa/_rDfaCtxt are unchanged.
+  bool FLoad( _TyNfa & _rNfa, _TyDfa & _rDfa, _TyDfaCtxt & _rDfaCtxt )
+  {
+    Assert( m_fHaveFingerprint );
+    Assert( !_rDfa.NStates() );
+    Assert( !_rDfaCtxt.m_pgnStart );
+    _cache_image ci;
+    {//B
+      ifstream ifs( PathCacheFile(), ios::in | ios::binary );
+      if ( !ifs.is_open() )
+        return false;
+      if ( !_FRead( ifs, ci ) )
+      {
+        n_SysLog::Log( eslmtWarning, "_dfa_cache::FLoad(): Cache file [%s] is invalid - ignoring.", PathCacheFile().string().c_str() );
+        return false;
+      }
+    }//EB
+    // Resolve all the action objects before modifying the DFA:
+    _rNfa.CreateActionIDLookup();
+    for ( _saved_action & rsa : ci.m_rgActions )
+    {
+      if ( !rsa.m_fHasObject )
+        continue;
+      typename _TyNfa::_TySetASByActionID::iterator it = _rNfa.m_pLookupActionID->find( rsa.m_aiAction );
+      if ( ( _rNfa.m_pLookupActionID->end() == it ) || !it->second->second.m_pSdpAction ||
+           ( (*it->second->second.m_pSdpAction)->VGetTokenId() != rsa.m_tidObject ) )
+      {
+        n_SysLog::Log( eslmtWarning, "_dfa_cache::FLoad(): Cache file [%s] doesn't match the action objects of the rule set - ignoring.", PathCacheFile().string().c_str() );
+        return false;
+      }
+      rsa.m_pSdpAction = it->second->second.m_pSdpAction.Ptr();
+    }
+
+    // Now construct - the only failures from here are allocation failures.
+    // REVIEW: <dbien>: Nodes not yet connected to the start state can be leaked on throw.
+    _rNfa.m_iActionCur = ci.m_iActionCurNfa;
+    _rDfa.m_setAlphabet.insert( ci.m_rgrngAlphabet.begin(), ci.m_rgrngAlphabet.end() );
+    _rDfa.m_fHasDeadState = ci.m_fHasDeadState;
+    _rDfa.m_fHasLookaheads = ci.m_fHasLookaheads;
+    _rDfa.m_nTriggers = ci.m_nTriggers;
+    _rDfa.m_nUnsatisfiableTransitions = ci.m_nUnsatisfiableTransitions;
+    _rDfa.m_iMaxActions = ci.m_iMaxActions;
+    for ( size_t stNode = 0; stNode < ci.m_rgLinksByState.size(); ++stNode )
+    {
+      _TyGraphNodeDfa * pgn;
+      _rDfa._NewStartState( &pgn );
+      if ( stNode == ci.m_stStart )
+        _rDfaCtxt.m_pgnStart = pgn; // The context owns the graph from here.
+    }
+    for ( size_t stNode = 0; stNode < ci.m_rgLinksByState.size(); ++stNode )
+    {
+      // _NewTransition() adds to the head of the child list so add in reverse:
+      vector< pair< _TyAlphaIndex, _TyState > > const & rrgLinks = ci.m_rgLinksByState[ stNode ];
+      for ( size_t stLink = rrgLinks.size(); stLink--; )
+        _rDfa._NewTransition( _rDfa.PGNGetNode( (_TyState)stNode ), rrgLinks[ stLink ].first, _rDfa.PGNGetNode( rrgLinks[ stLink ].second ), 0 );
+    }
+    for ( pair< _TyRangeEl, vtyTokenIdent > const & rpr : ci.m_rgTriggerTransitionToTokenId )
+      _rDfa.m_mapTriggerTransitionToTokenId.insert( rpr );
+    if ( ci.m_fHasMapTriggers )
+    {
+      _rDfa.m_pMapTriggers.template emplace< typename _TyDfa::_TyCompareAI const &, typename _TyDfa::_TyAllocator const & >(
+          typename _TyDfa::_TyCompareAI(), _rDfa.get_allocator() );
+      for ( size_t stAction : ci.m_rgiMapTriggers )
+      {
+        _TyAcceptAction aa( _AACreate( ci.m_rgActions[ stAction ], _rDfa ) );
+        typename _TyDfa::_TyMapTriggers::value_type vt( aa.m_aiAction, aa );
+        _rDfa.m_pMapTriggers->insert( vt );
+      }
+    }
+    _rDfaCtxt.CreateAcceptingNodeSet();
+    for ( size_t stAccept : ci.m_rgstAccept )
+      _rDfaCtxt.m_pssAccept->setbit( stAccept );
+    for ( pair< vector< size_t >, size_t > const & rprPart : ci.m_rgPartAccept )
+    {
+      _TySetStates ssPart( (size_t)_rDfa.NStates(), _rDfa.get_allocator() );
+      ssPart.clear();
+      for ( size_t stState : rprPart.first )
+        ssPart.setbit( stState );
+      _TyAcceptAction aa( _AACreate( ci.m_rgActions[ rprPart.second ], _rDfa ) );
+      typename _TyDfaCtxt::_TyPartAcceptStates::value_type vt( ssPart, aa );
+      _rDfaCtxt.m_partAccept.insert( vt );
+    }
+    return true;
+  }
+
+  // Save the optimized DFA for the current fingerprint. Returns false ( and logs ) if the DFA couldn't be saved - this isn't fatal.
+  bool FSave( _TyNfa const & _rNfa, _TyDfa & _rDfa, _TyDfaCtxt const & _rDfaCtxt )
+  {
+    Assert( m_fHaveFingerprint );
+    // We require a compressed node lookup with uncompressed transitions - i.e. the state just after optimization:
+    for ( _TyState nState = 0; nState < _rDfa.NStates(); ++nState )
+    {
+      _TyGraphNodeDfa * pgn = _rDfa.PGNGetNode( nState );
+      if ( !pgn || ( pgn->RElConst() != nState ) )
+      {
+        n_SysLog::Log( eslmtWarning, "_dfa_cache::FSave(): DFA node lookup isn't compressed - not caching." );
+        return false;
+      }
+    }
+    if ( !!_rDfa.m_pSetCompCharRange )
+    {
+      n_SysLog::Log( eslmtWarning, "_dfa_cache::FSave(): DFA transitions have been compressed - not caching." );
+      return false;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories( m_pathCacheDir, ec );
+    std::filesystem::path pathFile = PathCacheFile();
+    std::filesystem::path pathTemp = pathFile;
+    pathTemp += ".tmp";
+    {//B
+      ofstream ofs( pathTemp, ios::out | ios::binary | ios::trunc );
+      if ( !ofs.is_open() )
+      {
+        n_SysLog::Log( eslmtWarning, "_dfa_cache::FSave(): Unable to open [%s] for writing.", pathTemp.string().c_str() );
+        return false;
+      }
+      _Write( ofs, _rNfa, _rDfa, _rDfaCtxt );
+      ofs.flush();
+      if ( !ofs )
+      {
+        n_SysLog::Log( eslmtWarning, "_dfa_cache::FSave(): Error writing [%s].", pathTemp.string().c_str() );
+        ofs.close();
+        std::filesystem::remove( pathTemp, ec );
+        return false;
+      }
+    }//EB
+    // Rename into place so that concurrent builds never see a partial file:
+    std::filesystem::rename( pathTemp, pathFile, ec );
+    if ( !!ec )
+    {
+      n_SysLog::Log( eslmtWarning, "_dfa_cache::FSave(): Unable to rename [%s] to [%s]: %s.", pathTemp.string().c_str(), pathFile.string().c_str(), ec.message().c_str() );
+      std::filesystem::remove( pathTemp, ec );
+      return false;
+    }
+    return true;
+  }
+
+protected:
+  // 64bit FNV-1a.
+  struct _fingerprint
+  {
+    uint64_t m_u64{ 0xcbf29ce484222325ull };
+    void AddBytes( const void * _pv, size_t _nb )
+    {
+      const uint8_t * pbCur = (const uint8_t *)_pv;
+      const uint8_t * const pbEnd = pbCur + _nb;
+      for ( ; pbEnd != pbCur; ++pbCur )
+      {
+        m_u64 ^= *pbCur;
+        m_u64 *= 0x100000001b3ull;
+      }
+    }
+    template < class t_TyValue >
+    void Add( t_TyValue _v )
+    {
+      static_assert( is_arithmetic_v< t_TyValue > );
+      int64_t i64 = (int64_t)_v; // normalize the size.
+      AddBytes( &i64, sizeof i64 );
+    }
+    void AddString( string const & _rstr )
+    {
+      Add( _rstr.length() );
+      AddBytes( _rstr.c_str(), _rstr.length() );
+    }
+    uint64_t U64Get() const
+    {
+      return m_u64;
+    }
+  };
+  void _AddSetActionIds( _fingerprint & _rfp, _TySetActionIds const * _psr ) const
+  {
+    _rfp.Add( !!_psr );
+    if ( !_psr )
+      return;
+    _rfp.Add( _psr->size() );
+    for ( size_t st = _psr->getfirstset(); _psr->size() != st; st = _psr->getnextset( st ) )
+      _rfp.Add( st );
+  }
+  void _AddAcceptAction( _fingerprint & _rfp, _TyAcceptAction const & _raa ) const
+  {
+    _rfp.Add( (int)_raa.m_eaatType );
+    _rfp.Add( _raa.m_aiAction );
+    _rfp.Add( _raa.m_aiRelated );
+    _rfp.Add( !!_raa.m_pSdpAction );
+    if ( !!_raa.m_pSdpAction )
+    {
+      _rfp.Add( (*_raa.m_pSdpAction)->VGetTokenId() );
+      stringstream ss;
+      (*_raa.m_pSdpAction)->RenderActionType( ss, "t_TyTraits" );
+      _rfp.AddString( ss.str() );
+    }
+    _AddSetActionIds( _rfp, _raa.m_psrRelated.Ptr() );
+    _AddSetActionIds( _rfp, _raa.m_psrTriggers.Ptr() );
+  }
+
+  // Serialized accept action - the action object is referenced by the id of the NFA action that supplies it.
+  struct _saved_action
+  {
+    int m_eaatType{0};
+    vtyActionIdent m_aiAction{0};
+    vtyActionIdent m_aiRelated{0};
+    bool m_fHasObject{false};
+    vtyTokenIdent m_tidObject{0};
+    const typename _TyDfa::_TySdpActionBase * m_pSdpAction{nullptr}; // resolved on load.
+    bool m_fHasRelated{false};
+    size_t m_stRelatedSize{0};
+    vector< size_t > m_rgstRelated;
+    bool m_fHasTriggers{false};
+    size_t m_stTriggersSize{0};
+    vector< size_t > m_rgstTriggers;
+  };
+  // The in-memory image of a cache file - fully read and validated before we touch the DFA.
+  struct _cache_image
+  {
+    vtyActionIdent m_iActionCurNfa{0};
+    vector< _TyRange > m_rgrngAlphabet;
+    bool m_fHasDeadState{false};
+    bool m_fHasLookaheads{false};
+    size_t m_nTriggers{0};
+    size_t m_nUnsatisfiableTransitions{0};
+    vtyActionIdent m_iMaxActions{0};
+    size_t m_stStart{0};
+    vector< vector< pair< _TyAlphaIndex, _TyState > > > m_rgLinksByState;
+    vector< pair< _TyRangeEl, vtyTokenIdent > > m_rgTriggerTransitionToTokenId;
+    vector< _saved_action > m_rgActions;
+    bool m_fHasMapTriggers{false};
+    vector< size_t > m_rgiMapTriggers; // indices into m_rgActions.
+    vector< size_t > m_rgstAccept;
+    vector< pair< vector< size_t >, size_t > > m_rgPartAccept; // ( states, index into m_rgActions ).
+  };
+
+  template < class t_TyValue >
+  static void _WriteValue( ofstream & _rofs, t_TyValue _v )
+  {
+    static_assert( is_arithmetic_v< t_TyValue > );
+    int64_t i64 = (int64_t)_v;
+    _rofs.write( (const char *)&i64, sizeof i64 );
+  }
+  template < class t_TyValue >
+  static bool _FReadValue( ifstream & _rifs, t_TyValue & _rv )
+  {
+    int64_t i64;
+    if ( !_rifs.read( (char *)&i64, sizeof i64 ) )
+      return false;
+    _rv = (t_TyValue)i64;
+    return true;
+  }
+  static bool _FReadCount( ifstream & _rifs, size_t & _rst, size_t _stMax )
+  {
+    return _FReadValue( _rifs, _rst ) && ( _rst <= _stMax );
+  }
+  static bool _FReadStates( ifstream & _rifs, vector< size_t > & _rrgst, size_t _stLimit )
+  {
+    size_t stCount;
+    if ( !_FReadCount( _rifs, stCount, _stLimit ) )
+      return false;
+    _rrgst.resize( stCount );
+    for ( size_t & rst : _rrgst )
+    {
+      if ( !_FReadValue( _rifs, rst ) || ( rst >= _stLimit ) )
+        return false;
+    }
+    return true;
+  }
+  template < class t_TySet >
+  static void _WriteSet( ofstream & _rofs, t_TySet const & _rs )
+  {
+    _WriteValue( _rofs, _rs.countsetbits() );
+    for ( size_t st = _rs.getfirstset(); _rs.size() != st; st = _rs.getnextset( st ) )
+      _WriteValue( _rofs, st );
+  }
+  static void _WriteSetActionIds( ofstream & _rofs, _TySetActionIds const * _psr )
+  {
+    _WriteValue( _rofs, !!_psr );
+    if ( !!_psr )
+    {
+      _WriteValue( _rofs, _psr->size() );
+      _WriteSet( _rofs, *_psr );
+    }
+  }
+  static bool _FReadSetActionIds( ifstream & _rifs, bool & _rfHas, size_t & _rstSize, vector< size_t > & _rrgst )
+  {
+    if ( !_FReadValue( _rifs, _rfHas ) )
+      return false;
+    if ( !_rfHas )
+      return true;
+    return _FReadValue( _rifs, _rstSize ) && _FReadStates( _rifs, _rrgst, _rstSize );
+  }
+  static void _WriteAction( ofstream & _rofs, _TyAcceptAction const & _raa )
+  {
+    _WriteValue( _rofs, (int)_raa.m_eaatType );
+    _WriteValue( _rofs, _raa.m_aiAction );
+    _WriteValue( _rofs, _raa.m_aiRelated );
+    _WriteValue( _rofs, !!_raa.m_pSdpAction );
+    _WriteValue( _rofs, !!_raa.m_pSdpAction ? (*_raa.m_pSdpAction)->VGetTokenId() : vktidInvalidIdToken );
+    _WriteSetActionIds( _rofs, _raa.m_psrRelated.Ptr() );
+    _WriteSetActionIds( _rofs, _raa.m_psrTriggers.Ptr() );
+  }
+  static bool _FReadAction( ifstream & _rifs, _saved_action & _rsa )
+  {
+    return _FReadValue( _rifs, _rsa.m_eaatType ) && _FReadValue( _rifs, _rsa.m_aiAction ) && _FReadValue( _rifs, _rsa.m_aiRelated ) &&
+           _FReadValue( _rifs, _rsa.m_fHasObject ) && _FReadValue( _rifs, _rsa.m_tidObject ) &&
+           _FReadSetActionIds( _rifs, _rsa.m_fHasRelated, _rsa.m_stRelatedSize, _rsa.m_rgstRelated ) &&
+           _FReadSetActionIds( _rifs, _rsa.m_fHasTriggers, _rsa.m_stTriggersSize, _rsa.m_rgstTriggers );
+  }
+  static _TyAcceptAction _AACreate( _saved_action const & _rsa, _TyDfa & _rDfa )
+  {
+    _TyAcceptAction aa( _rsa.m_aiAction, _rsa.m_pSdpAction, _rDfa.get_allocator() );
+    aa.m_eaatType = (EActionActionType)_rsa.m_eaatType;
+    aa.m_aiRelated = _rsa.m_aiRelated;
+    if ( _rsa.m_fHasRelated )
+    {
+      aa.m_psrRelated.template emplace< typename _TySetActionIds::size_type, typename _TySetActionIds::_TyAllocator const & >( _rsa.m_stRelatedSize, aa.get_allocator() );
+      aa.m_psrRelated->clear();
+      for ( size_t st : _rsa.m_rgstRelated )
+        aa.m_psrRelated->setbit( st );
+    }
+    if ( _rsa.m_fHasTriggers )
+    {
+      aa.m_psrTriggers.template emplace< typename _TySetActionIds::size_type, typename _TySetActionIds::_TyAllocator const & >( _rsa.m_stTriggersSize, aa.get_allocator() );
+      aa.m_psrTriggers->clear();
+      for ( size_t st : _rsa.m_rgstTriggers )
+        aa.m_psrTriggers->setbit( st );
+    }
+    return aa;
+  }
+
+  void _Write( ofstream & _rofs, _TyNfa const & _rNfa, _TyDfa & _rDfa, _TyDfaCtxt const & _rDfaCtxt ) const
+  {
+    _WriteValue( _rofs, s_ku32Magic );
+    _WriteValue( _rofs, s_ku32Version );
+    _WriteValue( _rofs, m_u64Fingerprint );
+    _WriteValue( _rofs, _rNfa.m_iActionCur );
+    _WriteValue( _rofs, _rDfa.m_setAlphabet.size() );
+    for ( typename _TyDfa::_TyAlphabet::const_iterator itAlpha = _rDfa.m_setAlphabet.begin(); _rDfa.m_setAlphabet.end() != itAlpha; ++itAlpha )
+    {
+      _WriteValue( _rofs, itAlpha->first );
+      _WriteValue( _rofs, itAlpha->second );
+    }
+    _WriteValue( _rofs, _rDfa.m_fHasDeadState );
+    _WriteValue( _rofs, _rDfa.m_fHasLookaheads );
+    _WriteValue( _rofs, _rDfa.m_nTriggers );
+    _WriteValue( _rofs, _rDfa.m_nUnsatisfiableTransitions );
+    _WriteValue( _rofs, _rDfa.m_iMaxActions );
+    _WriteValue( _rofs, _rDfa.NStates() );
+    _WriteValue( _rofs, _rDfaCtxt.m_pgnStart->RElConst() );
+    for ( _TyState nState = 0; nState < _rDfa.NStates(); ++nState )
+    {
+      _TyGraphNodeDfa * pgn = _rDfa.PGNGetNode( nState );
+      size_t nLinks = 0;
+      for ( typename _TyGraphDfa::_TyLinkPosIterConst lpi( pgn->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+        ++nLinks;
+      _WriteValue( _rofs, nLinks );
+      for ( typename _TyGraphDfa::_TyLinkPosIterConst lpi( pgn->PPGLChildHead() ); !lpi.FIsLast(); lpi.NextChild() )
+      {
+        _WriteValue( _rofs, *lpi );
+        _WriteValue( _rofs, lpi.PGNChild()->RElConst() );
+      }
+    }
+    _WriteValue( _rofs, _rDfa.m_mapTriggerTransitionToTokenId.size() );
+    for ( typename _TyDfa::_TyMapTriggerTransitionToTokenId::const_iterator it = _rDfa.m_mapTriggerTransitionToTokenId.begin(); _rDfa.m_mapTriggerTransitionToTokenId.end() != it; ++it )
+    {
+      _WriteValue( _rofs, it->first );
+      _WriteValue( _rofs, it->second );
+    }
+    _WriteValue( _rofs, !!_rDfa.m_pMapTriggers );
+    if ( !!_rDfa.m_pMapTriggers )
+    {
+      _WriteValue( _rofs, _rDfa.m_pMapTriggers->size() );
+      for ( typename _TyDfa::_TyMapTriggers::const_iterator it = _rDfa.m_pMapTriggers->begin(); _rDfa.m_pMapTriggers->end() != it; ++it )
+        _WriteAction( _rofs, it->second );
+    }
+    _WriteSet( _rofs, *_rDfaCtxt.m_pssAccept );
+    _WriteValue( _rofs, _rDfaCtxt.m_partAccept.size() );
+    for ( typename _TyDfaCtxt::_TyPartAcceptStates::const_iterator it = _rDfaCtxt.m_partAccept.begin(); _rDfaCtxt.m_partAccept.end() != it; ++it )
+    {
+      _WriteSet( _rofs, it->first.RObject() );
+      _WriteAction( _rofs, it->second );
+    }
+  }
+  bool _FRead( ifstream & _rifs, _cache_image & _rci ) const
+  {
+    uint32_t u32Magic, u32Version;
+    uint64_t u64Fingerprint;
+    if ( !_FReadValue( _rifs, u32Magic ) || ( s_ku32Magic != u32Magic ) ||
+         !_FReadValue( _rifs, u32Version ) || ( s_ku32Version != u32Version ) ||
+         !_FReadValue( _rifs, u64Fingerprint ) || ( m_u64Fingerprint != u64Fingerprint ) ||
+         !_FReadValue( _rifs, _rci.m_iActionCurNfa ) )
+      return false;
+    static const size_t s_kstMaxCount = size_t( 1 ) << 32; // sanity limit.
+    size_t stCount;
+    if ( !_FReadCount( _rifs, stCount, s_kstMaxCount ) )
+      return false;
+    for ( size_t stAlpha = 0; stAlpha < stCount; ++stAlpha )
+    {
+      _TyRangeEl reFirst, reSecond;
+      if ( !_FReadValue( _rifs, reFirst ) || !_FReadValue( _rifs, reSecond ) || ( reFirst > reSecond ) )
+        return false;
+      _rci.m_rgrngAlphabet.push_back( _TyRange( reFirst, reSecond ) );
+    }
+    size_t nStates;
+    if ( !_FReadValue( _rifs, _rci.m_fHasDeadState ) || !_FReadValue( _rifs, _rci.m_fHasLookaheads ) ||
+         !_FReadValue( _rifs, _rci.m_nTriggers ) || !_FReadValue( _rifs, _rci.m_nUnsatisfiableTransitions ) ||
+         !_FReadValue( _rifs, _rci.m_iMaxActions ) || !_FReadCount( _rifs, nStates, s_kstMaxCount ) ||
+         !_FReadValue( _rifs, _rci.m_stStart ) || ( _rci.m_stStart >= nStates ) )
+      return false;
+    _rci.m_rgLinksByState.resize( nStates );
+    for ( vector< pair< _TyAlphaIndex, _TyState > > & rrgLinks : _rci.m_rgLinksByState )
+    {
+      if ( !_FReadCount( _rifs, stCount, _rci.m_rgrngAlphabet.size() ) )
+        return false;
+      rrgLinks.resize( stCount );
+      for ( pair< _TyAlphaIndex, _TyState > & rprLink : rrgLinks )
+      {
+        if ( !_FReadValue( _rifs, rprLink.first ) || ( rprLink.first < 0 ) || ( (size_t)rprLink.first >= _rci.m_rgrngAlphabet.size() ) ||
+             !_FReadValue( _rifs, rprLink.second ) || ( rprLink.second < 0 ) || ( (size_t)rprLink.second >= nStates ) )
+          return false;
+      }
+    }
+    if ( !_FReadCount( _rifs, stCount, s_kstMaxCount ) )
+      return false;
+    _rci.m_rgTriggerTransitionToTokenId.resize( stCount );
+    for ( pair< _TyRangeEl, vtyTokenIdent > & rpr : _rci.m_rgTriggerTransitionToTokenId )
+    {
+      if ( !_FReadValue( _rifs, rpr.first ) || !_FReadValue( _rifs, rpr.second ) )
+        return false;
+    }
+    if ( !_FReadValue( _rifs, _rci.m_fHasMapTriggers ) )
+      return false;
+    if ( _rci.m_fHasMapTriggers )
+    {
+      if ( !_FReadCount( _rifs, stCount, s_kstMaxCount ) )
+        return false;
+      for ( size_t stTrigger = 0; stTrigger < stCount; ++stTrigger )
+      {
+        _rci.m_rgiMapTriggers.push_back( _rci.m_rgActions.size() );
+        _rci.m_rgActions.emplace_back();
+        if ( !_FReadAction( _rifs, _rci.m_rgActions.back() ) )
+          return false;
+      }
+    }
+    if ( !_FReadStates( _rifs, _rci.m_rgstAccept, nStates ) || !_FReadCount( _rifs, stCount, nStates ) )
+      return false;
+    _rci.m_rgPartAccept.resize( stCount );
+    for ( pair< vector< size_t >, size_t > & rprPart : _rci.m_rgPartAccept )
+    {
+      rprPart.second = _rci.m_rgActions.size();
+      _rci.m_rgActions.emplace_back();
+      if ( !_FReadStates( _rifs, rprPart.first, nStates ) || !_FReadAction( _rifs, _rci.m_rgActions.back() ) )
+        return false;
+    }
+    // Should be at the end of the file:
+    return _rifs.peek() == char_traits< char >::eof();
+  }
+};
+
+__REGEXP_END_NAMESPACE
+
+#endif //__L_DFACH_H
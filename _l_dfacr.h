@@ -28,7 +28,8 @@ protected:
   _TyNfaCtxt & m_rNfaCtxt;
   _TyDfa & m_rDfa;
   _TyDfaCtxt & m_rDfaCtxt;
-  int m_iDfaNodeLimit;
+  size_t m_nDfaNodeLimit{0}; // If non-zero then create() fails when the DFA would have more states than this - see SetDfaNodeLimit().
+  size_t m_nThreads; // Number of threads to use to compute move sets - 1 means compute them inline, 0 means use hardware concurrency.
 
   typedef typename _TyNfa::_TyState _TyState;
 
@@ -48,6 +49,12 @@ protected:
   typedef forward_list< pair< _TyState, _TyState >, _TyDfaAcceptingListAlloc > _TyDfaAcceptingList;
   typedef typename _Alloc_traits< typename deque< const _TySetStatesNfa * >::value_type, _TyAllocatorNfa >::allocator_type _TyMapStateToSSAlloc;
   typedef deque< const _TySetStatesNfa *, _TyMapStateToSSAlloc > _TyMapStateToSS;
+  typedef typename _Alloc_traits< typename vector< _TySetStatesNfa >::value_type, _TyAllocatorNfa >::allocator_type _TyRgSetStatesNfaAlloc;
+  typedef vector< _TySetStatesNfa, _TyRgSetStatesNfaAlloc > _TyRgSetStatesNfa;
+
+  // When computing move sets in parallel we compute them for a batch of unprocessed DFA states at a time. Each DFA state needs
+  //  a move set per alphabet element so we limit the batch by the memory required:
+  static const size_t s_kstMoveBatchBytes = 64 * 1024 * 1024;
 
   // Lookahead disambiguating stuff:
   typedef typename _Alloc_traits< typename set< _TyState, less< _TyState > >::value_type, _TyAllocatorNfa >::allocator_type _TySetLDStatesAlloc;
@@ -85,11 +92,14 @@ protected:
   static const bool m_fAllowReject = false;
 
 public:
-  _create_dfa( _TyNfa & _rNfa, _TyNfaCtxt & _rNfaCtxt, _TyDfa & _rDfa, _TyDfaCtxt & _rDfaCtxt, bool _fCreateDeadState, size_t _stHashSize = 3000 )
+  // _nThreads: The number of threads with which to compute move sets during subset construction. The resultant DFA is identical regardless
+  //  of the number of threads since the new DFA states are still numbered and linked in the single threaded order.
+  _create_dfa( _TyNfa & _rNfa, _TyNfaCtxt & _rNfaCtxt, _TyDfa & _rDfa, _TyDfaCtxt & _rDfaCtxt, bool _fCreateDeadState, size_t _stHashSize = 3000, size_t _nThreads = 1 )
     : m_rNfa( _rNfa )
     , m_rNfaCtxt( _rNfaCtxt )
     , m_rDfa( _rDfa )
     , m_rDfaCtxt( _rDfaCtxt )
+    , m_nThreads( _nThreads )
     , m_sCur( 0 )
     , m_ssLookup( _stHashSize, typename _TyLookupSS::hasher(), typename _TyLookupSS::key_equal(), _rNfa.get_allocator() )
     , m_mapStateToSS( _rNfa.get_allocator() )
@@ -103,7 +113,14 @@ public:
     Assert( !_rDfaCtxt.m_pgnStart );
   }
 
-  // Returns false if we go over the node limit.
+  // Limit the number of DFA states - create() then returns false rather than construct a larger DFA. Zero means no limit.
+  // This allows the caller to fall back to a _lazy_dfa for rule sets that don't determinize within reason ( see FCreateDfaOrLazy() ).
+  void SetDfaNodeLimit( size_t _nDfaNodeLimit )
+  {
+    m_nDfaNodeLimit = _nDfaNodeLimit;
+  }
+
+  // Returns false if we go over the node limit - the DFA is then incomplete and should be discarded.
   bool create()
   {
     // We can't store iterators to a deque to which a push_back() or push_front() is called - so all bets are off with storing iterators.
@@ -184,8 +201,27 @@ public:
     typename _TyDfa::_TyAlphaIndex aiStart = ( typename _TyDfa::_TyAlphaIndex )( m_rDfa.m_setAlphabet.size() - 1 );
     typename _TyAlphabetDfa::iterator itAlphaBegin = m_rDfa.m_setAlphabet.begin();
 
+    // If we are using multiple threads then the move sets are computed in batches by the thread pool. The closure, lookup and
+    //  creation of DFA states remains sequential (and uses the closure cache) so that state numbering is deterministic.
+    optional< _l_thread_pool > optPool;
+    if ( 1 != m_nThreads )
+    {
+      optPool.emplace( m_nThreads );
+      if ( optPool->NThreads() < 2 )
+        optPool.reset();
+    }
+    _TyRgSetStatesNfa rgssMoveBatch( m_rNfa.get_allocator() );
+    _TyState sMoveBatchBegin = m_sCur;
+    _TyState sMoveBatchEnd = m_sCur;
+
     while ( m_sCur != m_rDfa.NStates() )
     {
+      if ( !!optPool && ( m_sCur == sMoveBatchEnd ) )
+      {
+        sMoveBatchBegin = m_sCur;
+        sMoveBatchEnd = _SComputeMoveBatch( *optPool, m_sCur, rgssMoveBatch );
+      }
+
       // For each input range - excluding the empty state:
       // Go backward through the set - this pushes the alphabet on in order.
       typename _TyDfa::_TyAlphaIndex aiCur = aiStart;
@@ -200,7 +236,13 @@ public:
       bool fContLoop = true;
       do
       {
-        m_rNfa.ComputeSetMoveStates( *m_pssCur, *itAlpha, *pssMove );
+        if ( !!optPool )
+        {
+          pssMove->swap( rgssMoveBatch[ (size_t)( m_sCur - sMoveBatchBegin ) * m_rDfa.m_setAlphabet.size() + (size_t)aiCur ] );
+          m_pssCur->clear();
+        }
+        else
+          m_rNfa.ComputeSetMoveStates( *m_pssCur, *itAlpha, *pssMove );
         Assert( m_pssCur->empty() );
         m_rNfa.ComputeSetClosure( *pssMove, *m_pssCur );
         Assert( pssMove->empty() );
@@ -217,6 +259,11 @@ public:
             _TyGraphNodeDfa * pgnNew;
             m_rDfa._NewAcceptingState( pgnCurDfa, aiCur, &pgnNew, pglFirstAdded ? 0 : &pglFirstAdded );
             (void)_NewDfaState( pgnNew );
+            if ( m_nDfaNodeLimit && ( (size_t)m_rDfa.NStates() > m_nDfaNodeLimit ) )
+            {
+              m_rNfa.DeallocClosureCache();
+              return false;
+            }
           }
           else
           {
@@ -321,6 +368,38 @@ public:
     return true;
   }
 
+  // Compute the move sets for a batch of DFA states starting at _sBegin in parallel. The move set for ( state, alphabet index ) is
+  //  placed at _rrgssMoveBatch[ ( state - _sBegin ) * alphabet size + alphabet index ].
+  // Returns the end of the batch.
+  _TyState _SComputeMoveBatch( _l_thread_pool & _rPool, _TyState _sBegin, _TyRgSetStatesNfa & _rrgssMoveBatch )
+  {
+    const size_t nAlpha = m_rDfa.m_setAlphabet.size();
+    const size_t stBytesState = nAlpha * m_pssCur->size_bytes();
+    size_t nStatesBatch = (std::max)( _rPool.NThreads(), s_kstMoveBatchBytes / ( stBytesState ? stBytesState : 1 ) );
+    nStatesBatch = (std::min)( nStatesBatch, (size_t)( m_rDfa.NStates() - _sBegin ) );
+    while ( _rrgssMoveBatch.size() < nStatesBatch * nAlpha )
+      _rrgssMoveBatch.emplace_back( (size_t)m_rNfa.NStates(), m_rNfa.get_allocator() );
+
+    // Copy the alphabet into a vector so each thread can index it directly:
+    typedef typename _Alloc_traits< typename vector< typename _TyAlphabetDfa::value_type >::value_type, _TyAllocatorNfa >::allocator_type _TyRgAlphaAlloc;
+    vector< typename _TyAlphabetDfa::value_type, _TyRgAlphaAlloc > rgAlpha( m_rDfa.m_setAlphabet.begin(), m_rDfa.m_setAlphabet.end(), m_rNfa.get_allocator() );
+
+    // ComputeMoveStates() only reads the NFA graph and writes the result set, and nothing else is modified until the pool is done, so this is safe:
+    _rPool.ParallelFor( nStatesBatch,
+      [this,_sBegin,nAlpha,&rgAlpha,&_rrgssMoveBatch]( size_t _stItem )
+      {
+        _TySetStatesNfa const & rssState = *m_mapStateToSS[ (size_t)_sBegin + _stItem ];
+        _TySetStatesNfa * pssMove = &_rrgssMoveBatch[ _stItem * nAlpha ];
+        for ( size_t stAlpha = 0; stAlpha < nAlpha; ++stAlpha, ++pssMove )
+        {
+          pssMove->clear();
+          for ( size_t stNfa = rssState.getfirstset(); rssState.size() != stNfa; stNfa = rssState.getnextset( stNfa ) )
+            m_rNfa.ComputeMoveStates( m_rNfa.PGNGetNode( (_TyState)stNfa ), rgAlpha[ stAlpha ], *pssMove );
+        }
+      } );
+    return _sBegin + (_TyState)nStatesBatch;
+  }
+
   _TySetStatesNfa const * _NewDfaState( _TyGraphNodeDfa * _pgn )
   {
     pair< typename _TyLookupSS::iterator, bool > pibInserted;
@@ -225,9 +225,23 @@ protected:
 	typedef vector< _TyGraphNode *, TyRgLookupRepAlloc > TyRgLookupRep;
 	TyRgLookupRep	m_rgLookupRep;
 
+	// Parallel partitioning: For large groups we compute the transition signature of each state
+	//	in parallel - the signatures are then inserted into the set of partition classes sequentially
+	//	in state order so that the resultant partition doesn't depend on the number of threads.
+	static const size_t s_knParallelGroupStates = 1024; // Groups smaller than this are processed inline.
+	static const size_t s_knSignatureChunkStates = 64; // The number of states processed by each thread pool item.
+	size_t	m_nThreads;	// 1 means no thread pool, 0 means use hardware concurrency.
+	optional< _l_thread_pool >	m_optPool;
+	typedef typename _Alloc_traits< typename vector< _TyState >::value_type, _TyAllocator >::allocator_type TyRgStatesAlloc;
+	typedef vector< _TyState, TyRgStatesAlloc > TyRgStates;
+	TyRgStates	m_rgStatesGroup;
+	typedef typename _Alloc_traits< typename vector< _TyPartitionEl * >::value_type, _TyAllocator >::allocator_type TyRgSignaturesAlloc;
+	typedef vector< _TyPartitionEl *, TyRgSignaturesAlloc > TyRgSignatures;
+	TyRgSignatures	m_rgpelSignatures;
+
 public:
 	
-	_optimize_dfa( _TyDfa & _rDfa, _TyDfaCtxt & _rDfaCtxt )
+	_optimize_dfa( _TyDfa & _rDfa, _TyDfaCtxt & _rDfaCtxt, size_t _nThreads = 1 )
 		:	_TyAllocVPBase( _rDfa.get_allocator() ),
 			_TyAllocPartClass( _rDfa.get_allocator() ),
 			m_rDfa( _rDfa ),
@@ -239,7 +253,10 @@ public:
 			m_stUsedClassCache( 0 ),
 			m_stSizeClassCache( 0 ),
 			m_setPartClasses( _TyCompPartClases( _rDfa.AlphabetSize() ), _rDfa.get_allocator() ),
-			m_rgLookupRep( m_rDfa.get_allocator() )
+			m_rgLookupRep( m_rDfa.get_allocator() ),
+			m_nThreads( _nThreads ),
+			m_rgStatesGroup( m_rDfa.get_allocator() ),
+			m_rgpelSignatures( m_rDfa.get_allocator() )
 	{
 		_TyPartitionEl peSingleton( _TyPartitionEl::s_kptNullPartition, _TySetStates( 0, m_rDfa.get_allocator() ) );
 		m_gcppeSingleton.template Create1< _TyPartitionEl const & >( peSingleton, m_rDfa.get_allocator() );
@@ -432,7 +449,16 @@ public:
 		Assert( ssUtil.empty() );
 
 		// Apply partitioning algorithm:
+		if ( 1 != m_nThreads )
+		{
+			m_optPool.emplace( m_nThreads );
+			if ( m_optPool->NThreads() < 2 )
+				m_optPool.reset();
+		}
 		_Partition(	ssUtil );
+		m_optPool.reset();
+		m_rgStatesGroup.clear();
+		m_rgpelSignatures.clear();
 
 		typename _TyPartition::iterator itUpper;
 		itUpper = m_partition.upper_bound( m_gcppeSingleton );
@@ -485,39 +511,52 @@ protected:
 			_rssUtil = ppelCur->second;	// Copy the set of states - we will modify below.
 
 			_TyPartitionClass **	pppc = _GetPartClass();	// Get a partition class from the cache.
+
+			_TyPartitionEl ** pppelSignatureCur = 0;
+			if ( !!m_optPool && ( _rssUtil.countsetbits() >= s_knParallelGroupStates ) )
+				pppelSignatureCur = _PPPelComputeSignatures( _rssUtil );
 	
 			_TyState	iStateTest;
 			for ( iStateTest = (_TyState)_rssUtil.getclearfirstset();
 						_rssUtil.size() != iStateTest;
 						iStateTest = _rssUtil.getclearfirstset( (size_t)iStateTest ) )
 			{
-				// Since we know we have a transition on every state out of every node
-				//	we can just iterate the links of the node for this state:
-				// We also know that the links are stored in order - with the last alphabet
-				//	element first ( though that doesn't matter - just as long as they are in the
-				//	same order at each node ).
-				_TyGraphNode * pgn = m_rDfa.PGNGetNode( iStateTest );
-				typename _TyGraph::_TyLinkPosIterConst	lpi( pgn->PPGLChildHead() );
+				if ( pppelSignatureCur )
+				{
+					// Signature already computed by the thread pool:
+					memcpy( (*pppc)->begin(), pppelSignatureCur, m_rDfa.AlphabetSize() * sizeof( _TyPartitionEl * ) );
+					pppelSignatureCur += m_rDfa.AlphabetSize();
+				}
+				else
+				{
+					// Since we know we have a transition on every state out of every node
+					//	we can just iterate the links of the node for this state:
+					// We also know that the links are stored in order - with the last alphabet
+					//	element first ( though that doesn't matter - just as long as they are in the
+					//	same order at each node ).
+					_TyGraphNode * pgn = m_rDfa.PGNGetNode( iStateTest );
+					typename _TyGraph::_TyLinkPosIterConst	lpi( pgn->PPGLChildHead() );
 
-				_TyPartitionEl ** pppelPartClass = (*pppc)->begin();
+					_TyPartitionEl ** pppelPartClass = (*pppc)->begin();
 
 #if ASSERTSENABLED
-				size_t dbg_nLinksCur = 0;
+					size_t dbg_nLinksCur = 0;
 #endif //ASSERTSENABLED
-				while( !lpi.FIsLast() )
-				{
+					while( !lpi.FIsLast() )
+					{
 #if ASSERTSENABLED
-					++dbg_nLinksCur;
+						++dbg_nLinksCur;
 #endif //ASSERTSENABLED
-					*pppelPartClass++ = m_rgsmeMap[ (size_t)lpi.PGNChild()->REl() ];
-					lpi.NextChild();
-				}
+						*pppelPartClass++ = m_rgsmeMap[ (size_t)lpi.PGNChild()->REl() ];
+						lpi.NextChild();
+					}
 #if ASSERTSENABLED
-				if ( size_t(-1) == dbg_nLinksFirst )
-					dbg_nLinksFirst = dbg_nLinksCur;
-				else
-					Assert( dbg_nLinksCur == dbg_nLinksFirst ); // Each node should have the same number of links out.
+					if ( size_t(-1) == dbg_nLinksFirst )
+						dbg_nLinksFirst = dbg_nLinksCur;
+					else
+						Assert( dbg_nLinksCur == dbg_nLinksFirst ); // Each node should have the same number of links out.
 #endif //ASSERTSENABLED
+				}
 
 				// Now attempt to insert this new transition container into the set of unique
 				//	transition sets of the current group of the partition:
@@ -557,6 +596,34 @@ protected:
 		while( m_partition.end() != itCur );
 	}
 
+	// Compute the transition signatures for the states in _rssGroup using the thread pool.
+	// Returns the signatures in state order, m_rDfa.AlphabetSize() elements per state.
+	_TyPartitionEl **	_PPPelComputeSignatures( _TySetStates const & _rssGroup )
+	{
+		m_rgStatesGroup.clear();
+		for ( size_t stState = _rssGroup.getfirstset(); _rssGroup.size() != stState; stState = _rssGroup.getnextset( stState ) )
+			m_rgStatesGroup.push_back( (_TyState)stState );
+		const size_t stAlphabet = m_rDfa.AlphabetSize();
+		m_rgpelSignatures.resize( m_rgStatesGroup.size() * stAlphabet );
+
+		// Nothing is modified during this - m_rgsmeMap and the graph are only read:
+		size_t nChunks = ( m_rgStatesGroup.size() + s_knSignatureChunkStates - 1 ) / s_knSignatureChunkStates;
+		m_optPool->ParallelFor( nChunks,
+			[this,stAlphabet]( size_t _stChunk )
+			{
+				size_t stStateEnd = (std::min)( m_rgStatesGroup.size(), ( _stChunk + 1 ) * s_knSignatureChunkStates );
+				for ( size_t stState = _stChunk * s_knSignatureChunkStates; stStateEnd != stState; ++stState )
+				{
+					_TyPartitionEl ** pppelCur = &m_rgpelSignatures[ stState * stAlphabet ];
+					typename _TyGraph::_TyLinkPosIterConst	lpi( m_rDfa.PGNGetNode( m_rgStatesGroup[ stState ] )->PPGLChildHead() );
+					for ( ; !lpi.FIsLast(); lpi.NextChild() )
+						*pppelCur++ = m_rgsmeMap[ (size_t)lpi.PGNChild()->REl() ];
+					Assert( pppelCur == &m_rgpelSignatures[ 0 ] + ( stState + 1 ) * stAlphabet ); // Each node should have a link for each alphabet element.
+				}
+			} );
+		return &m_rgpelSignatures[ 0 ];
+	}
+
 	void	_Split( typename _TyPartition::iterator	const & ritPartCur )
 	{
 		// Then the current group has been split:
@@ -24,6 +24,12 @@ struct _create_dfa;
 template < class t_TyDfa, bool f_tPartDeadImmed = true >
 struct _optimize_dfa;
 
+template < class t__TyNfa >
+class _lazy_dfa;
+
+template < class t__TyNfa, class t__TyDfa >
+class _dfa_cache;
+
 enum	EActionActionType
 {
 	e_aatNone = 0,
@@ -30,12 +30,16 @@
 #include "_l_chrng.h"
 #include "_l_axion.h"
 #include "_l_base.h"
+#include "_l_thrpl.h"
 #include "_l_fabas.h"
 #include "_l_nfa.h"
 #include "_l_rgexp.h"
 #include "_l_dfa.h"
 #include "_l_dfacr.h"
 #include "_l_dfopt.h"
+#include "_l_lzdfa.h"
+#include "_l_dfach.h"
+#include "_l_dfabk.h"
 #include "_l_lxgen.h"
 #include "_l_data.h"
 
@@ -34,6 +34,16 @@ enum EGeneratorDFAOptions : uint32_t
 	egdoDontTemplatizeStates, 
 		// Don't templatize the states of the state machine. This only works (of course) if there are no action or trigger function pointers associated with the states.
 		// If action function pointers are necessary in the state machine then an error is thrown indicating that 
+	egdoReorderStatesBreadthFirst,
+		// Renumber the states before generation - breadth first from the start state, likelier successors first. See _dfa_context::ReorderStates().
+	egdoReorderStatesReversePostOrder,
+		// Renumber the states before generation - reverse post-order of a depth first walk. Takes precedence over egdoReorderStatesBreadthFirst.
+	egdoDefaultTransitions,
+		// For states whose transitions cover every character, emit the most common destination as the state's default transition
+		//	rather than as explicit transitions. This reduces the number of transitions searched at runtime.
+	egdoDispatchActionsById,
+		// Generate non-templated states even when there are actions and triggers. The states reference _l_an_mostbase::_DispatchAction<tid>
+		//	and the generated analyzer supplies a table of its action methods indexed by token id. One set of states then serves all t_TyTraits.
 	egdoGeneratorDFAOptionsCount // This at the end always.
 };
 
@@ -72,18 +82,37 @@ struct _l_gen_dfa
 			m_sStartStateName( _pcStartStateName, _rA )
 	{
 		m_rDfa._CreateRangeLookup();
+		m_rDfaCtxt.ReorderStates( EDfaStateOrderGet() );
 		m_rDfaCtxt.CreateAcceptPartLookup();
-		VerifyThrowSz( !FDontTemplatizeStates() || !m_rDfa.m_nTriggers, 
+		VerifyThrowSz( !FDontTemplatizeStates() || FDispatchActionsById() || !m_rDfa.m_nTriggers, 
 			"Must have templatized states when triggers are present in the state machine. There are [%llu] triggers in the current DFA.", uint64_t(m_rDfa.m_nTriggers) );
 	}
 	bool FDontTemplatizeStates() const
 	{
-		return !!( ( 1ul << egdoDontTemplatizeStates ) & m_grfGeneratorDFAOptions );
+		return !!( ( ( 1ul << egdoDontTemplatizeStates ) | ( 1ul << egdoDispatchActionsById ) ) & m_grfGeneratorDFAOptions );
+	}
+	bool FDispatchActionsById() const
+	{
+		return !!( ( 1ul << egdoDispatchActionsById ) & m_grfGeneratorDFAOptions );
+	}
+	bool FDefaultTransitions() const
+	{
+		return !!( ( 1ul << egdoDefaultTransitions ) & m_grfGeneratorDFAOptions );
+	}
+	EDfaStateOrder EDfaStateOrderGet() const
+	{
+		if ( !!( ( 1ul << egdoReorderStatesReversePostOrder ) & m_grfGeneratorDFAOptions ) )
+			return edsoReversePostOrder;
+		if ( !!( ( 1ul << egdoReorderStatesBreadthFirst ) & m_grfGeneratorDFAOptions ) )
+			return edsoWeightedBreadthFirst;
+		return edsoConstruction;
 	}
 	_TyDfa & m_rDfa;
 	_TyDfaCtxt & m_rDfaCtxt;
 	_TyString m_sStartStateName;	// Special name for start state.
 	uint32_t m_grfGeneratorDFAOptions;
+	uint64_t m_u64Fingerprint{0}; // The _dfa_cache<> fingerprint of the rule set - only when added through the DFA cache.
+	bool m_fHaveFingerprint{false};
 };
 
 template < class t_TyDfa, class t_TyCharOut >
@@ -110,6 +139,8 @@ struct _l_generator
 
 	typedef basic_string< t_TyCharOut, char_traits<t_TyCharOut>, _TyAllocator >	_TyString;
 	typedef std::pair< _TyAlphaIndex, _TyAlphaIndex > _TyPrAI;
+	typedef std::pair< _TyRange, _TyGraphNode * > _TyGenTransition;
+	typedef vector< _TyGenTransition > _TyRgGenTransitions;
 
 	typedef _l_gen_dfa< _TyDfa, t_TyCharOut >		_TyGenDfa;
 
@@ -136,6 +167,70 @@ struct _l_generator
 	bool m_fLookaheads;
 	bool m_fTriggers;
 
+	// Compact state tables ( see _l_cmptb.h ). The transitions are then only in the compact tables - the _l_state<> objects
+	//	hold just the cold data. Set m_fCompactStateTables before calling generate().
+	bool m_fCompactStateTables{false};
+	// Generate the _l_state<> objects as constinit const data with no pointers between them - the trigger transition is then also
+	//	only in the compact tables. All generated tables are then constant initialized - constinit makes the compiler reject any
+	//	dynamic initialization - and const so that they end up in read-only memory. Requires m_fCompactStateTables.
+	bool m_fConstantTables{false};
+
+	// Merge states that are identical across all the DFAs ( see _DedupStates() ). Set m_fDedupStates before calling generate().
+	bool m_fDedupStates{false};
+	// Character 0 is an ordinary character of the input rather than eof. Default transitions must then also cover 0 and the
+	//	emitted analyzer uses an eof symbol beyond the character range ( see _l_analyzer<> ). Set before calling generate().
+	bool m_fNulIsCharacter{false};
+	// Some DFA has egdoDefaultTransitions - all states then get the extra default transition slot m_rgt[m_nt] and the analyzer
+	//	follows it ( see _l_analyzer<>::s_kfDefaultTransitions ). Set by add_dfa().
+	bool m_fDefaultTransitions{false};
+	typedef pair< typename _TyDfaList::value_type *, _TyGraphNode * > _TyDedupState;
+	vector< _TyDedupState > m_rgDedupStates; // All the states of all the DFAs by global state number.
+	vector< size_t > m_rgstDedupRep; // The emitted state for each global state number.
+	vector< size_t > m_rgstCompactIndex; // The compact table index for each emitted global state number.
+
+	// When set DFAs may be added from their NFAs - they are then created through the DFA cache in this directory ( see _l_dfach.h ).
+	//	If every DFA of a generate() was added this way and neither they nor the generator's settings have changed since the
+	//	existing header was generated then the header is left untouched.
+	_TyString m_sDfaCacheDir;
+	// Increment when the generated code changes so that headers left untouched by the DFA fingerprints are regenerated.
+	static constexpr uint32_t s_ku32HeaderVersion = 1;
+
+	// Write the state definitions to this many .cpp files next to the header rather than into the header ( see _WriteTableUnits() ).
+	//	The header then has only the extern declarations. Templated states are explicitly instantiated for each of m_rgsInstantiateTraits.
+	size_t m_nTableUnits{0};
+	vector< _TyString > m_rgsInstantiateTraits;
+
+	// Size and footprint figures for each generated DFA - see GetReportJsonValue(). Byte counts are estimated from the layouts of
+	//	_l_state<> and of the compact tables for the generated character type.
+	static constexpr size_t s_knLinearSearchMax = 5; // States with more transitions are binary searched - see _l_analyzer::_getnext().
+	static constexpr size_t s_kstCacheLineBytes = 64;
+	struct _TyDfaReport
+	{
+		_TyString m_sStartStateName;
+		size_t m_nStates{0};
+		size_t m_nTransitions{0};
+		size_t m_nBinarySearchStates{0};
+		size_t m_nDefaultTransitionStates{0};
+		size_t m_nAcceptStates{0};
+		size_t m_nTriggerStates{0};
+		size_t m_nLookaheadStates{0};
+		size_t m_nStateBytes{0}; // _l_state<> objects.
+		size_t m_nCompactBytes{0}; // Compact tables, if generated.
+		size_t m_nCacheLines{0}; // Sum over the states of the cache lines touched to find a transition.
+		size_t m_nCacheLinesMax{0};
+		vector< size_t > m_rgnTransitionHistogram; // Number of states by number of transitions.
+		size_t m_nMaxReread{0}; // From _dfa_backtrack_analysis - _dfa_backtrack_analysis::s_knUnbounded if backtrack prone.
+		size_t m_nUnboundedRereadStates{0};
+	};
+	vector< _TyDfaReport > m_rgDfaReports; // Filled in by generate().
+	size_t m_nStatesTotal{0}; // The number of states in all the DFAs - determines the width of a state index.
+	size_t m_nCompactTransitions{0};
+	ostringstream m_ossCompactStates;
+	ostringstream m_ossCompactTransitions;
+	ostringstream m_ossCompactStatePtrs;
+	vector< size_t > m_rgstCompactStartStates; // The compact index of the start state of each DFA.
+	string m_strFingerprints; // The fingerprint line written to the header - see _FGetFingerprints().
+
 	typedef _l_gen_action_info< _TyCharOut, _TyAllocator > _TyGenActionInfo;
 
 	// We insert the actions into a map. They are ordered by the unique token/trigger id.
@@ -234,6 +329,26 @@ enum EGeneratorDFAOptions : uint32_t
                                     m_mapActions.get_allocator() ) );
 		m_fLookaheads = m_fLookaheads || _rDfa.m_fHasLookaheads;
 		m_fTriggers = m_fTriggers || !!_rDfa.m_nTriggers;
+		m_fDefaultTransitions = m_fDefaultTransitions || !!( ( 1ul << egdoDefaultTransitions ) & _grfGeneratorDFAOptions );
+	}
+
+	// Load the optimized DFA for _rNfa from the DFA cache in m_sDfaCacheDir, or create, optimize and cache it, and then add it as above.
+	template < class t_TyNfa >
+	void add_dfa(	t_TyNfa & _rNfa,
+								typename t_TyNfa::_TyContext & _rNfaCtxt,
+								_TyDfa & _rDfa,
+								_TyDfaCtxt & _rDfaCtxt,
+								const t_TyCharOut * _pcStartStateName,
+								uint32_t _grfGeneratorDFAOptions = 0,
+								bool _fCreateDeadState = true,
+								size_t _nThreads = 1 )
+	{
+		VerifyThrowSz( !m_sDfaCacheDir.empty(), "m_sDfaCacheDir must be set to add a DFA through the DFA cache." );
+		_dfa_cache< t_TyNfa, _TyDfa > dc( m_sDfaCacheDir.c_str(), uint64_t( _fCreateDeadState ) );
+		(void)dc.FLoadOrCreate( _rNfa, _rNfaCtxt, _rDfa, _rDfaCtxt, _fCreateDeadState, _nThreads );
+		add_dfa( _rDfa, _rDfaCtxt, _pcStartStateName, _grfGeneratorDFAOptions );
+		m_lDfaGen.back().m_u64Fingerprint = dc.U64Fingerprint();
+		m_lDfaGen.back().m_fHaveFingerprint = true;
 	}
 
 	void add_action_info( vtyTokenIdent _tid, _TyGenActionInfo const & _rgai )
@@ -243,15 +358,39 @@ enum EGeneratorDFAOptions : uint32_t
 		// There is the possibility that the caller has duplicated a m_strActionName but if so the resultant code won't compile so no worries there.
 	}
 
+	// Add a traits type for which the templated states are explicitly instantiated when m_nTableUnits is set.
+	void add_instantiation_traits( const t_TyCharOut * _pcTraits )
+	{
+		m_rgsInstantiateTraits.push_back( _TyString( _pcTraits, get_allocator() ) );
+	}
+
 	void	generate()
 	{
     _unique_actions();
+		VerifyThrowSz( !m_nTableUnits || !m_rgsInstantiateTraits.empty() || _FAllStatesNonTemplated(), 
+			"Templated states written to separate translation units need at least one traits type to instantiate - see add_instantiation_traits()." );
 
+		VerifyThrowSz( !m_fConstantTables || m_fCompactStateTables, "Constant tables require compact state tables." );
+		if ( _FGetFingerprints( m_strFingerprints ) && _FHeaderHasFingerprints( m_strFingerprints ) )
+		{
+			// Nothing has changed since the existing header ( and its table units ) was generated:
+			m_lDfaGen.clear();
+			m_rgDfaReports.clear();
+			return;
+		}
     ofstream ofsHeader( m_sfnHeader.c_str() );
 
+		m_nStatesTotal = 0;
+		for ( typename _TyDfaList::iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+			m_nStatesTotal += lit->m_rDfa.NStates();
+		if ( m_fDedupStates )
+			m_nStatesTotal = _DedupStates();
+
 		_HeaderHeader( ofsHeader );
 
+		m_rgDfaReports.clear();
 		ostringstream ossStateDefinitions; // Stream these to a string first because they reference the unique action objects.
+		vector< ostringstream > rgossUnits( m_nTableUnits );
 		{ //B Generate state declarations.
 			Assert( !m_aiStart );
 			Assert( !m_stStart );
@@ -261,13 +400,20 @@ enum EGeneratorDFAOptions : uint32_t
 				m_pvtDfaCur = &*lit;
 
 				m_pvtDfaCur->m_rDfa.GetTriggerUnsatAIRanges( &m_praiTriggers, nullptr );
+				m_rgDfaReports.push_back( _TyDfaReport() );
+				m_rgDfaReports.back().m_sStartStateName = m_pvtDfaCur->m_sStartStateName;
+				_AnalyzeBacktracking();
 
 				_GenStateDecls( ofsHeader );
-				_GenStateDefinitions( ossStateDefinitions );
+				_GenStateDefinitions( ossStateDefinitions, m_nTableUnits ? &rgossUnits : nullptr );
+				if ( m_fCompactStateTables )
+					m_rgstCompactStartStates.push_back( _StCompactIndex( m_pvtDfaCur->m_rDfaCtxt.m_pgnStart ) );
 
 				m_aiStart += m_pvtDfaCur->m_rDfa.m_iMaxActions;
 				m_stStart += m_pvtDfaCur->m_rDfa.NStates();
 			}
+			if ( m_fCompactStateTables )
+				_GenCompactTables( ofsHeader ); // These only need the state declarations.
 		} //EB
 
 		if ( !FIsSpecializedGenerator() )
@@ -276,9 +422,195 @@ enum EGeneratorDFAOptions : uint32_t
 		ofsHeader << ossStateDefinitions.str();
 
 		_HeaderFooter( ofsHeader );
+		if ( m_nTableUnits )
+			_WriteTableUnits( rgossUnits );
 
     // Clear the associated rules:
     m_lDfaGen.clear();
+		m_rgDedupStates.clear();
+		m_rgstDedupRep.clear();
+		m_rgstCompactIndex.clear();
+	}
+
+	// Get the fingerprint line written to the header - the settings of the generator and the fingerprint of each DFA.
+	// Returns false if some DFA wasn't added through the DFA cache - we then can't tell whether the header is up to date.
+	bool	_FGetFingerprints( string & _rstrFingerprints ) const
+	{
+		_rstrFingerprints.clear();
+		if ( m_lDfaGen.empty() )
+			return false;
+		for ( typename _TyDfaList::const_iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+		{
+			if ( !lit->m_fHaveFingerprint )
+				return false;
+		}
+		// The settings that affect the generated code other than the DFAs themselves:
+		ostringstream ossSettings;
+		ossSettings << s_ku32HeaderVersion << "\n" << int( m_egfdFamilyDisp ) << "\n" << m_sfnHeader << "\n" << m_sPpBase << "\n" << m_fUseNamespaces << "\n"
+			<< m_sNamespace << "\n" << m_sBaseStateName << "\n" << m_sCharTypeName << "\n" << m_sVisibleCharPrefix << "\n" << m_sVisibleCharSuffix << "\n"
+			<< m_fCompactStateTables << m_fConstantTables << m_fDedupStates << m_fNulIsCharacter << "\n" << m_nTableUnits << "\n";
+		for ( _TyString const & rsTraits : m_rgsInstantiateTraits )
+			ossSettings << rsTraits << "\n";
+		for ( typename _TyMapActionInfo::const_iterator it = m_mapActionInfo.begin(); it != m_mapActionInfo.end(); ++it )
+			ossSettings << it->first << "\n" << it->second.m_strActionName << "\n" << it->second.m_strComment << "\n";
+		for ( typename _TyDfaList::const_iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+			ossSettings << lit->m_sStartStateName << "\n" << lit->m_grfGeneratorDFAOptions << "\n";
+		uint64_t u64Settings = 0xcbf29ce484222325ull; // 64bit FNV-1a.
+		string strSettings = ossSettings.str();
+		for ( char c : strSettings )
+		{
+			u64Settings ^= uint8_t( c );
+			u64Settings *= 0x100000001b3ull;
+		}
+		string strFingerprint;
+		PrintfStdStr( _rstrFingerprints, "// DFA fingerprints: %016llx", (unsigned long long)u64Settings );
+		for ( typename _TyDfaList::const_iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+		{
+			PrintfStdStr( strFingerprint, " %016llx", (unsigned long long)lit->m_u64Fingerprint );
+			_rstrFingerprints += strFingerprint;
+		}
+		return true;
+	}
+	// Does the existing header have the fingerprint line _rstrFingerprints in its preamble?
+	bool	_FHeaderHasFingerprints( string const & _rstrFingerprints ) const
+	{
+		ifstream ifsHeader( m_sfnHeader.c_str() );
+		string strLine;
+		for ( size_t nLine = 0; ( nLine < 8 ) && getline( ifsHeader, strLine ); ++nLine )
+		{
+			if ( !strLine.empty() && ( '\r' == strLine.back() ) )
+				strLine.pop_back();
+			if ( strLine == _rstrFingerprints )
+				return true;
+		}
+		return false;
+	}
+
+	// Find the states that are identical across all the DFAs - the same accept action and transitions on the same characters to
+	//	identical states - by Moore partition refinement over the union of the DFAs. Only one state of each class is emitted and
+	//	all references to the others are redirected to it. States involved in triggers or lookaheads carry ids specific to their
+	//	DFA and so are never merged. Start states are referenced by name and so are always emitted.
+	// Returns the number of states that will be emitted.
+	size_t	_DedupStates()
+	{
+		m_rgDedupStates.clear();
+		for ( typename _TyDfaList::iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+		{
+			for ( _TyState st = 0; st < lit->m_rDfa.NStates(); ++st )
+				m_rgDedupStates.push_back( _TyDedupState( &*lit, lit->m_rDfa.PGNGetNode( st ) ) );
+		}
+		const size_t knStates = m_rgDedupStates.size();
+
+		typedef tuple< _TyRangeEl, _TyRangeEl, size_t > _TyDedupTransition; // ( first, last, global state or class ).
+		typedef vector< _TyDedupTransition > _TyRgDedupTransitions;
+		vector< _TyRgDedupTransitions > rgrgTransitions( knStates );
+		vector< size_t > rgstClass( knStates );
+		size_t nClasses;
+		{//B Initial classes are by the state's own data.
+			map< string, size_t > mapKeys;
+			_TyRgGenTransitions rgTransitions;
+			for ( size_t stState = 0; stState < knStates; ++stState )
+			{
+				m_pvtDfaCur = m_rgDedupStates[ stState ].first;
+				_TyGraphNode * pgn = m_rgDedupStates[ stState ].second;
+				const size_t kstDfaStart = stState - pgn->RElConst();
+				_GetCoalescedTransitions( pgn, false, rgTransitions );
+				for ( typename _TyRgGenTransitions::const_iterator cit = rgTransitions.begin(); rgTransitions.end() != cit; ++cit )
+					rgrgTransitions[ stState ].push_back( _TyDedupTransition( cit->first.first, cit->first.second, kstDfaStart + cit->second->RElConst() ) );
+				rgstClass[ stState ] = mapKeys.insert( typename map< string, size_t >::value_type( _StrDedupKey( pgn, stState ), mapKeys.size() ) ).first->second;
+			}
+			nClasses = mapKeys.size();
+		}//EB
+		for ( ; ; )
+		{
+			// Refine by the classes of the destinations - coalescing ranges whose destinations are now in the same class:
+			typedef pair< size_t, _TyRgDedupTransitions > _TySignature;
+			map< _TySignature, size_t > mapSignatures;
+			vector< size_t > rgstClassNew( knStates );
+			for ( size_t stState = 0; stState < knStates; ++stState )
+			{
+				_TySignature sig( rgstClass[ stState ], _TyRgDedupTransitions() );
+				for ( typename _TyRgDedupTransitions::const_iterator cit = rgrgTransitions[ stState ].begin(); rgrgTransitions[ stState ].end() != cit; ++cit )
+				{
+					size_t stClass = rgstClass[ get< 2 >( *cit ) ];
+					if ( !sig.second.empty() && ( get< 2 >( sig.second.back() ) == stClass ) && ( get< 1 >( sig.second.back() ) + 1 == get< 0 >( *cit ) ) )
+						get< 1 >( sig.second.back() ) = get< 1 >( *cit );
+					else
+						sig.second.push_back( _TyDedupTransition( get< 0 >( *cit ), get< 1 >( *cit ), stClass ) );
+				}
+				rgstClassNew[ stState ] = mapSignatures.insert( typename map< _TySignature, size_t >::value_type( sig, mapSignatures.size() ) ).first->second;
+			}
+			rgstClass.swap( rgstClassNew );
+			if ( mapSignatures.size() == nClasses )
+				break; // Stable.
+			nClasses = mapSignatures.size();
+		}
+
+		// A start state represents its class if there is one, otherwise the lowest numbered state:
+		vector< size_t > rgstClassRep( nClasses, knStates );
+		for ( size_t stState = 0; stState < knStates; ++stState )
+		{
+			if ( _FIsDedupStartState( stState ) && ( knStates == rgstClassRep[ rgstClass[ stState ] ] ) )
+				rgstClassRep[ rgstClass[ stState ] ] = stState;
+		}
+		m_rgstDedupRep.resize( knStates );
+		m_rgstCompactIndex.assign( knStates, knStates );
+		size_t nEmitted = 0;
+		for ( size_t stState = 0; stState < knStates; ++stState )
+		{
+			size_t & rstRep = rgstClassRep[ rgstClass[ stState ] ];
+			if ( knStates == rstRep )
+				rstRep = stState;
+			m_rgstDedupRep[ stState ] = _FIsDedupStartState( stState ) ? stState : rstRep;
+			if ( stState == m_rgstDedupRep[ stState ] )
+				m_rgstCompactIndex[ stState ] = nEmitted++;
+		}
+		Trace( "_DedupStates(): Emitting [%zu] of [%zu] states.", nEmitted, knStates );
+		m_pvtDfaCur = nullptr;
+		return nEmitted;
+	}
+	bool	_FIsDedupStartState( size_t _stState ) const
+	{
+		return m_rgDedupStates[ _stState ].first->m_rDfaCtxt.m_pgnStart == m_rgDedupStates[ _stState ].second;
+	}
+	// The key for the initial partition - states with different keys are never merged.
+	string	_StrDedupKey( _TyGraphNode * _pgn, size_t _stState )
+	{
+		string strKey;
+		bool fUnique = false;
+		typename _TyGraph::_TyLinkPosIterConst	lpi( _pgn->PPGLChildHead() );
+		if ( !lpi.FIsLast() && _FIsTrigger( *lpi ) )
+			fUnique = true;
+		else
+		if ( m_pvtDfaCur->m_rDfaCtxt.m_pssAccept->isbitset( (size_t)_pgn->RElConst() ) )
+		{
+			const typename _TyPartAcceptStates::value_type *	pvtAction = m_pvtDfaCur->m_rDfaCtxt.PVTGetAcceptPart( _pgn->RElConst() );
+			Assert( !!pvtAction );
+			if ( ( pvtAction->second.m_eaatType & e_aatTrigger ) || 
+					 ( ( e_aatAccept != pvtAction->second.m_eaatType ) && ( e_aatAntiAccepting != pvtAction->second.m_eaatType ) ) )
+				fUnique = true;
+			else
+			if ( !!pvtAction->second.m_pSdpAction )
+				PrintfStdStr( strKey, "A%u:%d:%s", unsigned( pvtAction->second.m_eaatType ), (*pvtAction->second.m_pSdpAction)->VGetTokenId(), 
+					(*pvtAction->second.m_pSdpAction)->VStrTypeName( m_sCharTypeName.c_str() ).c_str() );
+			else
+				PrintfStdStr( strKey, "A%u", unsigned( pvtAction->second.m_eaatType ) );
+		}
+		if ( fUnique )
+			PrintfStdStr( strKey, "U%zu", _stState );
+		else
+			strKey += m_pvtDfaCur->FDontTemplatizeStates() ? ":N" : ":T";
+		return strKey;
+	}
+	// Whether we emit this state of the current DFA - false only if it is merged into another state.
+	bool	_FEmitState( _TyGraphNode * _pgn ) const
+	{
+		return !m_fDedupStates || ( m_rgstDedupRep[ _pgn->RElConst() + m_stStart ] == ( _pgn->RElConst() + m_stStart ) );
+	}
+	size_t	_StCompactIndex( _TyGraphNode * _pgn ) const
+	{
+		size_t stState = _pgn->RElConst() + m_stStart;
+		return m_fDedupStates ? m_rgstCompactIndex[ m_rgstDedupRep[ stState ] ] : stState;
 	}
 
 	// We expect completely unique actions at least at this point as we are translating to trigger/token numbers
@@ -302,7 +634,7 @@ enum EGeneratorDFAOptions : uint32_t
 					if ( rvt.second.m_pSdpAction )
 					{
 						// We support non-templated states only when action object don't have an associated object, but just a token it.
-						VerifyThrowSz( !m_pvtDfaCur->FDontTemplatizeStates() || (*rvt.second.m_pSdpAction)->FIsTokenIdOnly(), 
+						VerifyThrowSz( !m_pvtDfaCur->FDontTemplatizeStates() || m_pvtDfaCur->FDispatchActionsById() || (*rvt.second.m_pSdpAction)->FIsTokenIdOnly(), 
 							"Must templatize states when any actions objects are present in the state machine as the callback member functions depend on the type of the lexical analyzer." );
 						//Assert( !( e_aatTrigger & rvt.second.m_eaatType ) ); // Should see only non-trigger actions here.
 						if ( !(*rvt.second.m_pSdpAction)->FIsTokenIdOnly() )
@@ -368,6 +700,8 @@ enum EGeneratorDFAOptions : uint32_t
 		_ros << "#pragma once\n\n";
 		_ros << "// " << m_sfnHeader << "\n";
 		_ros << "// Generated DFA.\n";
+		if ( !m_strFingerprints.empty() )
+			_ros << m_strFingerprints << "\n";
 		_ros << "\n";
 		_ros << "#include \"_l_lxobj.h\"\n";
 		_ros << "#include \"_l_token.h\"\n";
@@ -391,8 +725,14 @@ enum EGeneratorDFAOptions : uint32_t
 		{
 			_ros << "template < class t_TyTraits >\nusing TGetAnalyzerBase = _l_analyzer< t_TyTraits"
 						<< ( m_fLookaheads ? ", true" : ", false" )
-						<< ( m_fTriggers ? ", true" : ", false" )
-						<< " >;\n";
+						<< ( m_fTriggers ? ", true" : ", false" );
+			if ( m_fCompactStateTables || m_fNulIsCharacter || _FDefaultTransitionSlot() )
+				_ros << ", false, " << ( m_fCompactStateTables ? _StrCompactStateIndexType() : _TyString( "void" ) );
+			if ( m_fNulIsCharacter || _FDefaultTransitionSlot() )
+				_ros << ( m_fNulIsCharacter ? ", true" : ", false" );
+			if ( _FDefaultTransitionSlot() )
+				_ros << ", true";
+			_ros << " >;\n";
 		}
 
 		_ros << "typedef _l_state_proto< " << m_sCharTypeName << " > " << m_sStateProtoTypedef << ";\n";
@@ -456,7 +796,8 @@ enum EGeneratorDFAOptions : uint32_t
 		if ( FIsStandaloneGenerator() )
 		{
 			// For a standalone generator we can reference the start state here because there is only one unique start state.
-			_ros << "\t\t: _TyBase( (" << m_sStateProtoTypedef << "*) & " << m_pvtDfaCur->m_sStartStateName << "<t_TyTraits>, "; 
+			_ros << "\t\t: _TyBase( (" << m_sStateProtoTypedef << "*) & " << m_pvtDfaCur->m_sStartStateName 
+						<< ( m_pvtDfaCur->FDontTemplatizeStates() ? ", " : "<t_TyTraits>, " ); 
 		}
 		else
 		{
@@ -467,7 +808,16 @@ enum EGeneratorDFAOptions : uint32_t
 			_ros << strPreviousAction;
 		else
 			_ros << "nullptr;";
-		_ros << " )\n\t{ }\n";
+		_ros << " )\n";
+		ostringstream ossCtorBody;
+		if ( m_fCompactStateTables && FIsStandaloneGenerator() )
+			ossCtorBody << "\t\tthis->SetCompactTables( & " << _StrCompactTablesName() << ( _FAllStatesNonTemplated() ? "" : "<t_TyTraits>" ) << " );\n";
+		if ( _FAnyDispatchActionsById() )
+			_GenDispatchActions( ossCtorBody );
+		if ( ossCtorBody.str().empty() )
+			_ros << "\t{ }\n";
+		else
+			_ros << "\t{\n" << ossCtorBody.str() << "\t}\n";
 
 		_ros << "};\n\n";
 		_ros << "template < class t_TyTraits >\n";
@@ -475,6 +825,334 @@ enum EGeneratorDFAOptions : uint32_t
 		_ros << "\n";
 	}
 
+	bool	_FAllStatesNonTemplated() const
+	{
+		for ( typename _TyDfaList::const_iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+		{
+			if ( !lit->FDontTemplatizeStates() )
+				return false;
+		}
+		return true;
+	}
+	bool	_FAnyDispatchActionsById() const
+	{
+		for ( typename _TyDfaList::const_iterator lit = m_lDfaGen.begin(); lit != m_lDfaGen.end(); ++lit )
+		{
+			if ( lit->FDispatchActionsById() )
+				return true;
+		}
+		return false;
+	}
+	// Generate the action table, indexed by token id, used by states generated with egdoDispatchActionsById.
+	void	_GenDispatchActions( ostream & _ros )
+	{
+		typedef map< vtyTokenIdent, const _TyString * > _TyMapDispatch;
+		_TyMapDispatch mapDispatch;
+		typename _TyMapActions::const_iterator itMAEnd = m_mapActions.end();
+		for ( typename _TyMapActions::const_iterator itMA = m_mapActions.begin(); itMA != itMAEnd; ++itMA )
+		{
+			if ( !itMA->second.second )
+				continue; // Not referenced - not generated.
+			vtyTokenIdent tid = itMA->first->VGetTokenId();
+			VerifyThrowSz( tid >= 0, "Negative token id[%d] cannot be dispatched by id.", tid );
+			VerifyThrowSz( mapDispatch.insert( typename _TyMapDispatch::value_type( tid, &itMA->second.first.m_strActionName ) ).second,
+				"More than one action has token id[%d] - cannot dispatch by id.", tid );
+		}
+		if ( mapDispatch.empty() )
+			return;
+		_ros << "\t\tstatic constexpr typename _TyBase::_TyPMFnAccept s_krgpmfnDispatchActions[] = {";
+		vtyTokenIdent tidNext = 0;
+		for ( typename _TyMapDispatch::const_iterator cit = mapDispatch.begin(); mapDispatch.end() != cit; ++cit )
+		{
+			for ( ; tidNext < cit->first; ++tidNext )
+				_ros << "\n\t\t\tnullptr,";
+			_ros << "\n\t\t\tstatic_cast< typename _TyBase::_TyPMFnAccept >( &_TyThis::Action" << cit->second->c_str() << " ),";
+			++tidNext;
+		}
+		_ros << "\n\t\t};\n";
+		_ros << "\t\tthis->SetDispatchActions( s_krgpmfnDispatchActions, " << tidNext << " );\n";
+	}
+
+	// The state index is 16bit if all the states of a standalone generator fit, otherwise 32bit. Families of analyzers share
+	//	a single analyzer base and so always use 32bit indices. The high bit of an index is the accept tag.
+	_TyString _StrCompactStateIndexType() const
+	{
+		return ( FIsStandaloneGenerator() && ( m_nStatesTotal < 0x7fff ) ) ? "uint16_t" : "uint32_t";
+	}
+	_TyString _StrCompactTablesTypedef() const
+	{
+		return _TyString( "vTyCompactTables" ) + m_sCharTypeNameHumanReadable;
+	}
+	_TyString _StrCompactTablesName() const
+	{
+		return m_sBaseStateName + "_CompactTables" + m_sCharTypeNameHumanReadable;
+	}
+	void	_GenCompactStateIndex( ostream & _ros, _TyGraphNode * _pgn )
+	{
+		if ( !!_pgn )
+		{
+			_ros << _StCompactIndex( _pgn );
+			if ( strcmp( "0", _PcAcceptFlag( _pgn ) ) )
+				_ros << " | " << _StrCompactTablesTypedef() << "::s_kiAcceptTag";
+		}
+		else
+			_ros << _StrCompactTablesTypedef() << "::s_kiNullState";
+	}
+	// Record the compact form of the state just generated by _GenImpState().
+	void	_AddCompactState( _TyGraphNode * _pgn, _TyRgGenTransitions const & _rrgTransitions, const char * _pcAccept, 
+													_TyGraphNode * _pgnDefault, _TyGraphNode * _pgnTrigger )
+	{
+		m_ossCompactStates << "\t{ " << m_nCompactTransitions << ", " << _rrgTransitions.size() << ", " << _pcAccept << ", ";
+		_GenCompactStateIndex( m_ossCompactStates, _pgnDefault );
+		m_ossCompactStates << ", ";
+		_GenCompactStateIndex( m_ossCompactStates, _pgnTrigger );
+		m_ossCompactStates << " }, // " << ( _pgn->RElConst() + m_stStart ) << "\n";
+		typename _TyRgGenTransitions::const_iterator citEnd = _rrgTransitions.end();
+		for ( typename _TyRgGenTransitions::const_iterator cit = _rrgTransitions.begin(); citEnd != cit; ++cit )
+		{
+			m_ossCompactTransitions << "\t{ ";
+			_CharOut( m_ossCompactTransitions, cit->first.first );
+			m_ossCompactTransitions << ", ";
+			_CharOut( m_ossCompactTransitions, cit->first.second );
+			m_ossCompactTransitions << ", ";
+			_GenCompactStateIndex( m_ossCompactTransitions, cit->second );
+			m_ossCompactTransitions << " },\n";
+			++m_nCompactTransitions;
+		}
+		m_ossCompactStatePtrs << "\t";
+		_GenStateAddress( m_ossCompactStatePtrs, _pgn );
+		m_ossCompactStatePtrs << ",\n";
+	}
+	// The states were generated in index order so the compact tables are complete here. They hold only integers and the
+	//	addresses of the declared states and so are all constinit.
+	void	_GenCompactTables( ostream & _ros )
+	{
+		_TyString strStates = m_sBaseStateName + "_CompactStates" + m_sCharTypeNameHumanReadable;
+		_TyString strTransitions = m_sBaseStateName + "_CompactTransitions" + m_sCharTypeNameHumanReadable;
+		_TyString strStatePtrs = m_sBaseStateName + "_CompactStatePtrs" + m_sCharTypeNameHumanReadable;
+		_TyString strStartStates = m_sBaseStateName + "_CompactStartStates" + m_sCharTypeNameHumanReadable;
+		_ros << "\ntypedef _l_compact_tables< " << m_sCharTypeName << ", " << _StrCompactStateIndexType() << " > " << _StrCompactTablesTypedef() << ";\n";
+		_ros << "inline constinit const " << _StrCompactTablesTypedef() << "::_TyCompactState " << strStates << "[] = {\n";
+		_ros << m_ossCompactStates.str() << "};\n";
+		_ros << "inline constinit const " << _StrCompactTablesTypedef() << "::_TyTransition " << strTransitions << "[] = {\n";
+		if ( !m_nCompactTransitions )
+			_ros << "\t{ 0, 0, " << _StrCompactTablesTypedef() << "::s_kiNullState }, // No transitions - avoid a zero length array.\n";
+		_ros << m_ossCompactTransitions.str() << "};\n";
+		// When no state is templated a single set of tables serves all t_TyTraits:
+		const bool kfTemplated = !_FAllStatesNonTemplated();
+		if ( kfTemplated )
+			_ros << "template < class t_TyTraits >\n";
+		_ros << "inline constinit const void * const " << strStatePtrs << "[] = {\n";
+		_ros << m_ossCompactStatePtrs.str() << "};\n";
+		_ros << "inline constinit const " << _StrCompactStateIndexType() << " " << strStartStates << "[] = { ";
+		for ( size_t stStart = 0; stStart < m_rgstCompactStartStates.size(); ++stStart )
+			_ros << ( stStart ? ", " : "" ) << m_rgstCompactStartStates[ stStart ];
+		_ros << " };\n";
+		if ( kfTemplated )
+			_ros << "template < class t_TyTraits >\n";
+		_ros << "inline constinit const " << _StrCompactTablesTypedef() << " " << _StrCompactTablesName() << " = { " << strStates << ", " << strTransitions << ", "
+					<< strStatePtrs << ( kfTemplated ? "<t_TyTraits>, " : ", " ) << m_nStatesTotal << ", " 
+					<< strStartStates << ", " << m_rgstCompactStartStates.size() << " };\n\n";
+		m_nCompactTransitions = 0;
+		m_rgstCompactStartStates.clear();
+		m_ossCompactStates.str( _TyString() );
+		m_ossCompactTransitions.str( _TyString() );
+		m_ossCompactStatePtrs.str( _TyString() );
+	}
+
+	// Write each of the translation units holding the state definitions. They are named after the header: <header>_tables<n>.cpp.
+	void	_WriteTableUnits( vector< ostringstream > const & _rrgossUnits )
+	{
+		typename _TyString::size_type stSlash = m_sfnHeader.find_last_of( "/\\" );
+		_TyString sHeaderName = ( _TyString::npos == stSlash ) ? m_sfnHeader : m_sfnHeader.substr( stSlash + 1 );
+		typename _TyString::size_type stDot = m_sfnHeader.find_last_of( '.' );
+		_TyString sUnitBase = ( ( _TyString::npos == stDot ) || ( ( _TyString::npos != stSlash ) && ( stDot < stSlash ) ) ) ? m_sfnHeader : m_sfnHeader.substr( 0, stDot );
+		for ( size_t stUnit = 0; stUnit < _rrgossUnits.size(); ++stUnit )
+		{
+			ostringstream ossName;
+			ossName << sUnitBase << "_tables" << stUnit << ".cpp";
+			ofstream ofsUnit( ossName.str().c_str() );
+			VerifyThrowSz( !!ofsUnit, "Unable to open [%s] for writing.", ossName.str().c_str() );
+			ofsUnit << "// " << ossName.str() << "\n";
+			ofsUnit << "// Generated DFA state definitions for " << sHeaderName << ".\n\n";
+			ofsUnit << "#include \"" << sHeaderName << "\"\n\n";
+			if ( m_fUseNamespaces )
+			{
+				ofsUnit << "__" << m_sPpBase << "_BEGIN_NAMESPACE\n";
+				ofsUnit << "__LEXOBJ_USING_NAMESPACE\n\n";
+			}
+			ofsUnit << _rrgossUnits[ stUnit ].str();
+			_HeaderFooter( ofsUnit );
+		}
+	}
+
+	// Return the report of the sizes of the DFAs from the last generate(). This can be logged with n_SysLog or written out.
+	n_SysLog::vtyJsoValueSysLog GetReportJsonValue() const
+	{
+		n_SysLog::vtyJsoValueSysLog jv(ejvtObject);
+		jv("CharType").SetStringValue( std::string( m_sCharTypeName.c_str() ) );
+		if ( m_fCompactStateTables )
+			jv("CompactStateIndex").SetStringValue( std::string( _StrCompactStateIndexType().c_str() ) );
+		size_t nStateBytes = 0, nCompactBytes = 0;
+		n_SysLog::vtyJsoValueSysLog & jvDfas = jv("Dfas");
+		for ( size_t stDfa = 0; stDfa < m_rgDfaReports.size(); ++stDfa )
+		{
+			_TyDfaReport const & rdr = m_rgDfaReports[ stDfa ];
+			n_SysLog::vtyJsoValueSysLog jvDfa(ejvtObject);
+			jvDfa("StartState").SetStringValue( std::string( rdr.m_sStartStateName.c_str() ) );
+			jvDfa("States").SetValue( rdr.m_nStates );
+			jvDfa("Transitions").SetValue( rdr.m_nTransitions );
+			n_SysLog::vtyJsoValueSysLog & jvHistogram = jvDfa("TransitionHistogram");
+			for ( size_t nt = 0; nt < rdr.m_rgnTransitionHistogram.size(); ++nt )
+				jvHistogram( nt ).SetValue( rdr.m_rgnTransitionHistogram[ nt ] );
+			jvDfa("BinarySearchStates").SetValue( rdr.m_nBinarySearchStates );
+			jvDfa("DefaultTransitionStates").SetValue( rdr.m_nDefaultTransitionStates );
+			jvDfa("AcceptStates").SetValue( rdr.m_nAcceptStates );
+			jvDfa("TriggerStates").SetValue( rdr.m_nTriggerStates );
+			jvDfa("LookaheadStates").SetValue( rdr.m_nLookaheadStates );
+			jvDfa("StateBytes").SetValue( rdr.m_nStateBytes );
+			if ( m_fCompactStateTables )
+				jvDfa("CompactBytes").SetValue( rdr.m_nCompactBytes );
+			jvDfa("CacheLinesPerState").SetValue( !rdr.m_nStates ? 0.0 : double( rdr.m_nCacheLines ) / double( rdr.m_nStates ) );
+			jvDfa("CacheLinesPerStateMax").SetValue( rdr.m_nCacheLinesMax );
+			jvDfa("BacktrackProne").SetValue( !!rdr.m_nUnboundedRereadStates );
+			if ( rdr.m_nUnboundedRereadStates )
+				jvDfa("UnboundedRereadStates").SetValue( rdr.m_nUnboundedRereadStates );
+			else
+				jvDfa("MaxReread").SetValue( rdr.m_nMaxReread );
+			jvDfas( stDfa ) = jvDfa;
+			nStateBytes += rdr.m_nStateBytes;
+			nCompactBytes += rdr.m_nCompactBytes;
+		}
+		jv("StateBytes").SetValue( nStateBytes );
+		if ( m_fCompactStateTables )
+			jv("CompactBytes").SetValue( nCompactBytes );
+		return jv;
+	}
+	// Find the worst case re-reading of input after an accept in the current DFA and warn if it is unbounded - a lexer
+	//	with such rules can be quadratic in the input length.
+	void	_AnalyzeBacktracking()
+	{
+		typedef _dfa_backtrack_analysis< _TyDfa > _TyBacktrackAnalysis;
+		_TyBacktrackAnalysis dba( m_pvtDfaCur->m_rDfaCtxt );
+		dba.Analyze();
+		_TyDfaReport & rdr = m_rgDfaReports.back();
+		rdr.m_nMaxReread = dba.NMaxReread();
+		for ( typename _TyBacktrackAnalysis::_accept_backtrack const & rab : dba.RGetResults() )
+			rdr.m_nUnboundedRereadStates += rab.FUnbounded();
+		if ( dba.FBacktrackProne() )
+		{
+			ostringstream ss;
+			dba.Dump( ss );
+			n_SysLog::Log( eslmtWarning, "%s: [%zu] accepting state(s) may be followed by an unbounded re-read of the input:\n%s", 
+				m_pvtDfaCur->m_sStartStateName.c_str(), rdr.m_nUnboundedRereadStates, ss.str().c_str() );
+		}
+	}
+	static size_t _StRoundUp( size_t _st, size_t _stAlign )
+	{
+		return ( ( _st + _stAlign - 1 ) / _stAlign ) * _stAlign;
+	}
+	size_t	_StCharBytes() const
+	{
+		if ( ( m_sCharTypeName == "char" ) || ( m_sCharTypeName == "char8_t" ) )
+			return 1;
+		if ( m_sCharTypeName == "char16_t" )
+			return 2;
+		if ( m_sCharTypeName == "char32_t" )
+			return 4;
+		return sizeof( wchar_t );
+	}
+	// The common members of _l_state_proto<> before m_rgt[].
+	static size_t _StStateHeaderBytes()
+	{
+		size_t st = sizeof( vTyNTransitions ) + sizeof( vTyNTriggers ) + sizeof( vTyStateFlags ) + 2 * sizeof( unsigned short ) + sizeof( vtyTokenIdent );
+#ifdef LXOBJ_STATENUMBERS
+		st += sizeof( vTyStateNumber );
+#endif //LXOBJ_STATENUMBERS
+		return _StRoundUp( st, sizeof( void * ) ) + sizeof( void * ); // m_pspTrigger.
+	}
+	// Whether the states have the default transition slot m_rgt[m_nt] - with compact tables the states have no transitions.
+	bool	_FDefaultTransitionSlot() const
+	{
+		return m_fDefaultTransitions && !m_fCompactStateTables;
+	}
+	size_t	_StTransitionBytes() const
+	{
+		return _StRoundUp( 2 * _StCharBytes(), sizeof( void * ) ) + sizeof( void * );
+	}
+	size_t	_StCompactIndexBytes() const
+	{
+		return ( _StrCompactStateIndexType() == "uint16_t" ) ? 2 : 4;
+	}
+	size_t	_StCompactStateBytes() const
+	{
+		return _StRoundUp( _StRoundUp( sizeof( uint32_t ) + sizeof( vTyNTransitions ) + sizeof( vTyStateFlags ), _StCompactIndexBytes() ) + 2 * _StCompactIndexBytes(), sizeof( uint32_t ) );
+	}
+	size_t	_StCompactTransitionBytes() const
+	{
+		return _StRoundUp( _StRoundUp( 2 * _StCharBytes(), _StCompactIndexBytes() ) + _StCompactIndexBytes(), (std::max)( _StCharBytes(), _StCompactIndexBytes() ) );
+	}
+	// Cache lines touched finding a transition: the state's header and then either the whole linear search or one line per
+	//	binary search probe.
+	static size_t _StCacheLines( size_t _nHeaderBytes, size_t _nt, size_t _nTransitionBytes )
+	{
+		if ( _nt <= s_knLinearSearchMax )
+			return _StRoundUp( _nHeaderBytes + _nt * _nTransitionBytes, s_kstCacheLineBytes ) / s_kstCacheLineBytes;
+		size_t nProbes = 0;
+		for ( size_t nt = _nt; !!nt; nt >>= 1 )
+			++nProbes;
+		return _StRoundUp( _nHeaderBytes, s_kstCacheLineBytes ) / s_kstCacheLineBytes + 
+			(std::min)( nProbes, _StRoundUp( _nt * _nTransitionBytes, s_kstCacheLineBytes ) / s_kstCacheLineBytes );
+	}
+	// Add the state just generated by _GenImpState() to the current DFA's report.
+	void	_AddToReport( _TyRgGenTransitions const & _rrgTransitions, int _nOuts, _TyGraphNode * _pgnDefault, 
+											const typename _TyPartAcceptStates::value_type * _pvtAction, bool _fTrigger )
+	{
+		typedef bool ( _TyDfaReport::*_TyPMFnAny )(); // Same size as the action member function pointers.
+		_TyDfaReport & rdr = m_rgDfaReports.back();
+		const size_t knt = _rrgTransitions.size();
+		++rdr.m_nStates;
+		rdr.m_nTransitions += knt;
+		if ( rdr.m_rgnTransitionHistogram.size() <= knt )
+			rdr.m_rgnTransitionHistogram.resize( knt + 1 );
+		++rdr.m_rgnTransitionHistogram[ knt ];
+		if ( knt > s_knLinearSearchMax )
+			++rdr.m_nBinarySearchStates;
+		if ( !!_pgnDefault )
+			++rdr.m_nDefaultTransitionStates;
+		if ( _fTrigger )
+			++rdr.m_nTriggerStates;
+		size_t nStateBytes = _StStateHeaderBytes() + size_t( _nOuts + int( _FDefaultTransitionSlot() ) ) * _StTransitionBytes();
+		if ( !!_pvtAction )
+		{
+			const unsigned kuType = _pvtAction->second.m_eaatType & ~e_aatTrigger;
+			if ( kuType && ( e_aatAntiAccepting != kuType ) )
+			{
+				++rdr.m_nAcceptStates;
+				nStateBytes += sizeof( _TyPMFnAny );
+			}
+			if ( ( e_aatLookahead == kuType ) || ( e_aatLookaheadAccept == kuType ) || 
+					 ( e_aatLookaheadAcceptAndAccept == kuType ) || ( e_aatLookaheadAcceptAndLookahead == kuType ) )
+			{
+				++rdr.m_nLookaheadStates;
+				nStateBytes += sizeof( vtyActionIdent ) + ( !_pvtAction->second.m_psrRelated ? 0 : _pvtAction->second.m_psrRelated->size_bytes() );
+			}
+			if ( _pvtAction->second.m_eaatType & e_aatTrigger )
+				nStateBytes += sizeof( _TyPMFnAny ) * ( !_pvtAction->second.m_psrTriggers ? 1 : _pvtAction->second.m_psrTriggers->countsetbits() );
+		}
+		rdr.m_nStateBytes += _StRoundUp( nStateBytes, sizeof( void * ) );
+		size_t nCacheLines;
+		if ( m_fCompactStateTables )
+		{
+			rdr.m_nCompactBytes += _StCompactStateBytes() + knt * _StCompactTransitionBytes() + sizeof( void * );
+			nCacheLines = _StCacheLines( _StCompactStateBytes(), knt, _StCompactTransitionBytes() );
+		}
+		else
+			nCacheLines = _StCacheLines( _StStateHeaderBytes(), knt, _StTransitionBytes() );
+		rdr.m_nCacheLines += nCacheLines;
+		rdr.m_nCacheLinesMax = (std::max)( rdr.m_nCacheLinesMax, nCacheLines );
+	}
+
 	void	_HeaderFooter( ostream & _ros )
 	{
 		if ( m_fUseNamespaces )
@@ -489,11 +1167,13 @@ enum EGeneratorDFAOptions : uint32_t
 	{
 		if ( !m_pvtDfaCur->FDontTemplatizeStates() )
 			_ros	<< "template < class t_TyTraits >\n";
-		_ros	<< "extern ";
+		_ros	<< ( m_fConstantTables ? "extern const " : "extern " );
 		bool fIsTriggerAction, fIsTriggerGateway, fIsAntiAcceptingState;
 		vtyTokenIdent tidTokenTrigger; // These get recorded if there is a trigger in the transitions.
 		_TyRangeEl rgelTrigger; 
-		_GenStateType( _ros, _pgn, _nOuts, _fAccept, fIsTriggerAction, fIsTriggerGateway, fIsAntiAcceptingState, tidTokenTrigger, rgelTrigger );
+		_TyRgGenTransitions rgTransitions;
+		_TyGraphNode * pgnDefault;
+		_GenStateType( _ros, _pgn, _nOuts, _fAccept, fIsTriggerAction, fIsTriggerGateway, fIsAntiAcceptingState, tidTokenTrigger, rgelTrigger, rgTransitions, pgnDefault );
 		if ( _pgn == m_pvtDfaCur->m_rDfaCtxt.m_pgnStart )
 		{
 			// Use the special start state name:
@@ -532,9 +1212,96 @@ enum EGeneratorDFAOptions : uint32_t
 		Assert(m_praiTriggers.second >= 0);
 		return ( _rre >= (_TyRangeEl)m_praiTriggers.first ) && ( _rre < (_TyRangeEl)m_praiTriggers.second );
 	}
+	// Return the transitions of _pgn sorted by character with consecutive ranges to the same destination coalesced.
+	void	_GetCoalescedTransitions( _TyGraphNode * _pgn, bool _fSkipTrigger, _TyRgGenTransitions & _rrgTransitions )
+	{
+		_rrgTransitions.clear();
+		typename _TyGraph::_TyLinkPosIterConst	lpi( _pgn->PPGLChildHead() );
+		if ( _fSkipTrigger )
+			lpi.NextChild();
+		for ( ; !lpi.FIsLast(); lpi.NextChild() )
+			_rrgTransitions.push_back( _TyGenTransition( m_pvtDfaCur->m_rDfa.LookupRange( *lpi ), lpi.PGNChild() ) );
+		if ( _rrgTransitions.empty() )
+			return;
+		sort( _rrgTransitions.begin(), _rrgTransitions.end(), 
+			[]( _TyGenTransition const & _rl, _TyGenTransition const & _rr ) { return _rl.first.first < _rr.first.first; } );
+		size_t stOut = 0;
+		for ( size_t stIn = 1; stIn < _rrgTransitions.size(); ++stIn )
+		{
+			if ( ( _rrgTransitions[ stOut ].second == _rrgTransitions[ stIn ].second ) &&
+					 _rrgTransitions[ stOut ].first.isconsecutiveright( _rrgTransitions[ stIn ].first ) )
+				_rrgTransitions[ stOut ].first.second = _rrgTransitions[ stIn ].first.second;
+			else
+				_rrgTransitions[ ++stOut ] = _rrgTransitions[ stIn ];
+		}
+		_rrgTransitions.resize( stOut + 1 );
+	}
+	// Get the character transitions to generate for _pgn - those of _GetCoalescedTransitions().
+	// If default transitions are enabled and the transitions cover every character then the most common destination is
+	//	returned in _rpgnDefault and its transitions are removed from _rrgTransitions.
+	void	_GetGenTransitions( _TyGraphNode * _pgn, bool _fSkipTrigger, _TyRgGenTransitions & _rrgTransitions, _TyGraphNode *& _rpgnDefault )
+	{
+		_rpgnDefault = nullptr;
+		_GetCoalescedTransitions( _pgn, _fSkipTrigger, _rrgTransitions );
+		if ( _rrgTransitions.empty() || !m_pvtDfaCur->FDefaultTransitions() )
+			return;
+		// Unless m_fNulIsCharacter character 0 is never in the alphabet ( it is eof at runtime ) so we require coverage of [1,max]:
+		_TyRangeEl reNext = m_fNulIsCharacter ? 0 : 1;
+		const _TyRangeEl kreMax = (_TyRangeEl)(numeric_limits< typename _l_char_type_map< _TyCharGen >::_TyUnsigned >::max)();
+		for ( typename _TyRgGenTransitions::const_iterator cit = _rrgTransitions.begin(); _rrgTransitions.end() != cit; ++cit )
+		{
+			if ( ( cit->first.first > reNext ) || ( cit->first.second > kreMax ) )
+				return; // A gap or a non-character transition.
+			reNext = cit->first.second + 1;
+		}
+		if ( reNext <= kreMax )
+			return;
+		// Choose the destination with the most transitions - ties to the lowest state number for deterministic output:
+		typedef map< _TyState, size_t > _TyMapCounts;
+		_TyMapCounts mapCounts;
+		for ( typename _TyRgGenTransitions::const_iterator cit = _rrgTransitions.begin(); _rrgTransitions.end() != cit; ++cit )
+			++mapCounts[ cit->second->RElConst() ];
+		typename _TyMapCounts::const_iterator citMax = mapCounts.begin();
+		for ( typename _TyMapCounts::const_iterator cit = citMax; mapCounts.end() != cit; ++cit )
+		{
+			if ( cit->second > citMax->second )
+				citMax = cit;
+		}
+		_rpgnDefault = m_pvtDfaCur->m_rDfa.PGNGetNode( citMax->first );
+		_rrgTransitions.erase( remove_if( _rrgTransitions.begin(), _rrgTransitions.end(), 
+			[_rpgnDefault]( _TyGenTransition const & _rgt ) { return _rgt.second == _rpgnDefault; } ), _rrgTransitions.end() );
+	}
+
+	void	_GenStateAddress( ostream & _ros, _TyGraphNode * _pgn )
+	{
+		typename _TyDfaList::value_type * pvtDfa = m_pvtDfaCur;
+		size_t stState = _pgn->RElConst() + m_stStart;
+		if ( m_fDedupStates )
+		{
+			// The state may have been merged into a state of another DFA:
+			stState = m_rgstDedupRep[ stState ];
+			pvtDfa = m_rgDedupStates[ stState ].first;
+			_pgn = m_rgDedupStates[ stState ].second;
+		}
+		_ros << "& ";
+		if ( pvtDfa->m_rDfaCtxt.m_pgnStart == _pgn )
+			_ros << pvtDfa->m_sStartStateName;
+		else
+			_ros << m_sBaseStateName << "_"  << stState;
+		if ( !pvtDfa->FDontTemplatizeStates() )
+			_ros << "<t_TyTraits>";
+	}
+	void	_GenStatePtr( ostream & _ros, _TyGraphNode * _pgn )
+	{
+		_ros << "(" << m_sStateProtoTypedef << "*)( ";
+		_GenStateAddress( _ros, _pgn );
+		_ros << " )";
+	}
+
 	void	_GenStateType(	ostream & _ros, _TyGraphNode * _pgn, 
 												int _nOuts, bool _fAccept, bool & _rfIsTriggerAction, bool & _rfIsTriggerGateway, bool & _rIsAntiAcceptingState,
-												vtyTokenIdent & _rtidTokenTrigger, _TyRangeEl & _rrgelTrigger )
+												vtyTokenIdent & _rtidTokenTrigger, _TyRangeEl & _rrgelTrigger, 
+												_TyRgGenTransitions & _rrgTransitions, _TyGraphNode *& _rpgnDefault )
 	{
 		const typename _TyPartAcceptStates::value_type *	pvtAction = 0;
 		if ( _fAccept )
@@ -584,10 +1351,14 @@ enum EGeneratorDFAOptions : uint32_t
 		{
 			--_nOuts;	// The zeroth transition is the trigger.
 		}
+		_GetGenTransitions( _pgn, _rfIsTriggerAction || _rfIsTriggerGateway, _rrgTransitions, _rpgnDefault );
+#else // !LXGEN_OUTPUT_TRIGGERS
+		_GetGenTransitions( _pgn, false, _rrgTransitions, _rpgnDefault );
 #endif // !LXGEN_OUTPUT_TRIGGERS
+		_nOuts = m_fCompactStateTables ? 0 : (int)_rrgTransitions.size(); // Compact tables have the transitions only in the compact tables.
 
 		_ros	<< "_l_state< " << m_sCharTypeName << ", " 
-					<< _nOuts << ", ";
+					<< ( _nOuts + int( _FDefaultTransitionSlot() ) ) << ", ";
 		if ( pvtAction )
 		{
 			switch( pvtAction->second.m_eaatType & ~e_aatTrigger )
@@ -666,6 +1437,32 @@ enum EGeneratorDFAOptions : uint32_t
 		}
 	}
 
+	// Return the constant for the accept flag ( _l_state_proto::m_flAccept ) of _pgn.
+	const char * _PcAcceptFlag( _TyGraphNode * _pgn )
+	{
+		if ( !m_pvtDfaCur->m_rDfaCtxt.m_pssAccept->isbitset( (size_t)_pgn->RElConst() ) )
+			return "0";
+		const typename _TyPartAcceptStates::value_type *	pvtAction = m_pvtDfaCur->m_rDfaCtxt.PVTGetAcceptPart( _pgn->RElConst() );
+		Assert( !!pvtAction );
+		switch( pvtAction->second.m_eaatType & ~e_aatTrigger )
+		{
+			case e_aatAccept:
+				return "kucAccept";
+			case e_aatLookahead:
+				return "kucLookahead";
+			case e_aatLookaheadAccept:
+				return "kucLookaheadAccept";
+			case e_aatLookaheadAcceptAndAccept:
+				return "kucLookaheadAcceptAndAccept";
+			case e_aatLookaheadAcceptAndLookahead:
+				return "kucLookaheadAcceptAndLookahead";
+			case e_aatAntiAccepting:
+				return "kucAntiAccepting";
+			default:
+				return "0";
+		}
+	}
+
 	void	_GenImpState(	ostream & _ros, _TyGraphNode * _pgn, 
 											int _nOutsOrig, bool _fAccept )
 	{
@@ -673,11 +1470,17 @@ enum EGeneratorDFAOptions : uint32_t
 		bool fIsTriggerAction, fIsTriggerGateway, fIsAntiAcceptingState;
 		vtyTokenIdent tidTokenTrigger; // These get recorded if there is a trigger in the transitions.
 		_TyRangeEl rgelTrigger; 
-		_GenStateType( _ros, _pgn, _nOutsOrig, _fAccept, fIsTriggerAction, fIsTriggerGateway, fIsAntiAcceptingState, tidTokenTrigger, rgelTrigger );
+		_TyRgGenTransitions rgTransitions;
+		_TyGraphNode * pgnDefault;
+		_GenStateType( _ros, _pgn, _nOutsOrig, _fAccept, fIsTriggerAction, fIsTriggerGateway, fIsAntiAcceptingState, tidTokenTrigger, rgelTrigger, rgTransitions, pgnDefault );
 		_ros << " _Ty" << m_sBaseStateName << ( _pgn->RElConst() + m_stStart ) << ";\n";
 		if ( !m_pvtDfaCur->FDontTemplatizeStates() )
 			_ros << "template < class t_TyTraits > ";
-		_ros << "inline\n";
+		// Definitions in separate translation units aren't inline - they have a single definition each:
+		if ( m_nTableUnits )
+			_ros << ( m_fConstantTables ? "constinit const\n" : "\n" );
+		else
+			_ros << ( m_fConstantTables ? "inline constinit const\n" : "inline\n" );
 		_ros << "_Ty" << m_sBaseStateName << ( _pgn->RElConst() + m_stStart ) << " ";
 		const typename _TyPartAcceptStates::value_type *	pvtAction = 0;
 		if ( _pgn == m_pvtDfaCur->m_rDfaCtxt.m_pgnStart )
@@ -689,7 +1492,7 @@ enum EGeneratorDFAOptions : uint32_t
 			_ros	<< m_sBaseStateName << "_" << ( _pgn->RElConst() + m_stStart );
 		}
 		_ros << " = {\n#ifdef LXOBJ_STATENUMBERS\n\t" << ( _pgn->RElConst() + m_stStart ) << ",\n#endif //LXOBJ_STATENUMBERS\n\t";
-		int _nOuts = _nOutsOrig;
+		int _nOuts = m_fCompactStateTables ? 0 : (int)rgTransitions.size();
 		if ( _fAccept )
 		{
 			pvtAction = m_pvtDfaCur->m_rDfaCtxt.PVTGetAcceptPart( _pgn->RElConst() );
@@ -697,12 +1500,6 @@ enum EGeneratorDFAOptions : uint32_t
 			if ( !!pvtAction->second.m_pSdpAction )
 				Trace( "State[%zu] Action[%s] pvtAction[0x%zx]", size_t(_pgn->RElConst()), (*pvtAction->second.m_pSdpAction)->VStrTypeName( m_sCharTypeName.c_str() ).c_str(), pvtAction );
 		}
-#ifndef LXGEN_OUTPUT_TRIGGERS
-		if ( fIsTriggerAction || fIsTriggerGateway )
-		{
-			--_nOuts;	// The zeroth transition is the trigger.
-		}
-#endif //!LXGEN_OUTPUT_TRIGGERS
 		_ros	<< _nOuts << ", ";
 		if ( fIsTriggerAction )
 		{
@@ -722,72 +1519,22 @@ enum EGeneratorDFAOptions : uint32_t
 			_ros << "0, ";
 		}
 
-		if ( _fAccept )
-		{
-			switch( pvtAction->second.m_eaatType & ~e_aatTrigger )
-			{
-				case e_aatAccept:
-				{
-					_ros << "kucAccept, ";
-				}
-				break;
-				case e_aatLookahead:
-				{
-					_ros << "kucLookahead, ";
-				}
-				break;
-				case e_aatLookaheadAccept:
-				{
-					_ros << "kucLookaheadAccept, ";
-				}
-				break;
-				case e_aatLookaheadAcceptAndAccept:
-				{
-					_ros << "kucLookaheadAcceptAndAccept, ";
-				}
-				break;
-				case e_aatLookaheadAcceptAndLookahead:
-				{
-					_ros << "kucLookaheadAcceptAndLookahead, ";
-				}
-				break;
-				case e_aatAntiAccepting:
-				{
-					_ros << "kucAntiAccepting, ";
-				}
-				break;
-				default:
-				{
-					_ros << "0, ";
-				}
-				break;
-			}
-		}
-		else
-		{
-			_ros << "0, ";
-		}
+		const char * pcAccept = _PcAcceptFlag( _pgn ); // The accept flag - also recorded in the compact state.
+		_ros << pcAccept << ", ";
+		_TyGraphNode * pgnTrigger = nullptr;
 		if ( fIsTriggerAction || ( fIsTriggerGateway && !fIsAntiAcceptingState ) )
+			pgnTrigger = (*(_pgn->PPGLChildHead()))->PGNChild();
+		// With constant tables the trigger transition is only in the compact tables.
+		if ( !!pgnTrigger && !m_fConstantTables )
 		{
 			// Then the first transition is the trigger:
-			_ros << "(" << m_sStateProtoTypedef << "*)( & ";
-			if ( (*(_pgn->PPGLChildHead()))->PGNChild() == m_pvtDfaCur->m_rDfaCtxt.m_pgnStart )
-			{
-				_ros	<< m_pvtDfaCur->m_sStartStateName << "<t_TyTraits>";
-			}
-			else
-			{
-				_ros	<< m_sBaseStateName << "_" << 
-					( (*(_pgn->PPGLChildHead()))->PGNChild()->RElConst() + m_stStart );
-				_ros << "<t_TyTraits>";
-			}
-			_ros << " ), ";
+			_GenStatePtr( _ros, pgnTrigger );
+			_ros << ", ";
 		}
 		else
 		{
 			_ros << "0, ";
 		}
-
 		// Offsets for accept and trigger transitions in the variable length struct:
 		if ( pvtAction )
 		{
@@ -824,56 +1571,48 @@ enum EGeneratorDFAOptions : uint32_t
 		{
 			_ros << "0, 0, vktidInvalidIdToken";
 		}
+		if ( m_fCompactStateTables )
+			_AddCompactState( _pgn, rgTransitions, pcAccept, pgnDefault, pgnTrigger );
+		_AddToReport( rgTransitions, _nOuts, pgnDefault, pvtAction, fIsTriggerAction || fIsTriggerGateway );
 
-		if ( _nOuts )
+		if ( _nOuts || _FDefaultTransitionSlot() )
 		{
 			_ros << ",\n";
 			_ros << "\t{\n";
-			typename _TyGraph::_TyLinkPosIterNonConst	lpi( _pgn->PPGLChildHead() );
-#ifndef LXGEN_OUTPUT_TRIGGERS
-			if ( fIsTriggerAction || fIsTriggerGateway )
-			{
-				lpi.NextChild();	// Skip the trigger transition.
-			}
-#endif // !LXGEN_OUTPUT_TRIGGERS
-
-			while ( !lpi.FIsLast() )
+			typename _TyRgGenTransitions::const_iterator citEnd = rgTransitions.end();
+			for ( typename _TyRgGenTransitions::const_iterator cit = rgTransitions.begin(); citEnd != cit; )
 			{
-				_TyRange r = m_pvtDfaCur->m_rDfa.LookupRange( *lpi );
+				_TyRange r = cit->first;
 				_ros	<< "\t\t{ ";
 				_CharOut( _ros, r.first );
 				 _ros << ", ";
 				_CharOut( _ros, r.second );
-
-				_ros << ", (" << m_sStateProtoTypedef << "*)( & ";
-				if ( m_pvtDfaCur->m_rDfaCtxt.m_pgnStart == lpi.PGNChild() )
-				{
-					_ros << m_pvtDfaCur->m_sStartStateName;
-					if ( !m_pvtDfaCur->FDontTemplatizeStates() )
-						_ros << "<t_TyTraits>";
-				}
-				else
-				{
-					_ros << m_sBaseStateName << "_"  << ( lpi.PGNChild()->RElConst() + m_stStart );
-					if ( !m_pvtDfaCur->FDontTemplatizeStates() )
-						_ros << "<t_TyTraits>";
-				}
-				_ros << " ) }";
-
-				bool fIsTrigger = _FIsTrigger( *lpi );
-				lpi.NextChild();
-				if ( !lpi.FIsLast() )
+				_ros << ", ";
+				_GenStatePtr( _ros, cit->second );
+				_ros << " }";
+				if ( ( ++cit != citEnd ) || _FDefaultTransitionSlot() )
 				{
 					_ros << ",";
 				}
-				if ( fIsTrigger )
+#ifdef LXGEN_OUTPUT_TRIGGERS
+				typename _TyDfa::_TyMapTriggerTransitionToTokenId::const_iterator citTrigger = m_pvtDfaCur->m_rDfa.m_mapTriggerTransitionToTokenId.find( r.first );
+				if ( citTrigger != m_pvtDfaCur->m_rDfa.m_mapTriggerTransitionToTokenId.end() )
 				{
-					typename _TyDfa::_TyMapTriggerTransitionToTokenId::const_iterator cit = m_pvtDfaCur->m_rDfa.m_mapTriggerTransitionToTokenId.find( r.first );
-					VerifyThrowSz( cit != m_pvtDfaCur->m_rDfa.m_mapTriggerTransitionToTokenId.end(), "Couldn't find trigger transition [0x%zx] in m_mapTriggerTransitionToTokenId.", size_t(r.first) );
-					_ros << " /* TokenId[" << cit->second << "] */";
+					_ros << " /* TokenId[" << citTrigger->second << "] */";
 				}
+#endif //LXGEN_OUTPUT_TRIGGERS
 				_ros << "\n";
 			}
+			if ( _FDefaultTransitionSlot() )
+			{
+				// The default transition slot m_rgt[m_nt] - only m_psp is used:
+				_ros << "\t\t{ 0, 0, ";
+				if ( !!pgnDefault )
+					_GenStatePtr( _ros, pgnDefault );
+				else
+					_ros << "0";
+				_ros << " } /* default */\n";
+			}
 			_ros << "\t}";
 
 			if ( _fAccept )
@@ -905,6 +1644,12 @@ enum EGeneratorDFAOptions : uint32_t
 		typename _TyMapActions::value_type & rvtUnique = *itUnique;
 		rvtUnique.second.second = true;	// referenced this action.
 		
+		if ( m_pvtDfaCur->FDispatchActionsById() )
+		{
+			// Dispatched through the analyzer's table by token id - no reference to the lexical analyzer's type:
+			_ros << "\n\t&_l_an_mostbase< " << m_sCharTypeName << " >::_DispatchAction< " << _raob.VGetTokenId() << " >";
+			return;
+		}
 		_ros	<< "\n\tstatic_cast< typename TGetAnalyzerBase<t_TyTraits>::_TyPMFnAccept >( &TGetLexicalAnalyzer<t_TyTraits>::Action" 
 					<< rvtUnique.second.first.m_strActionName.c_str() << " )";
 	}
@@ -1027,22 +1772,46 @@ enum EGeneratorDFAOptions : uint32_t
 		for ( ; nit != nitEnd; ++nit )
 		{
 			_TyGraphNode *	pgn = static_cast< _TyGraphNode * >( *nit );
+			if ( !_FEmitState( pgn ) )
+				continue;
 			int	nOuts = pgn->UChildren();	// We could record this earlier - like during both creation and optimization.
 			bool	fAccept = m_pvtDfaCur->m_rDfaCtxt.m_pssAccept->isbitset( (size_t)pgn->RElConst() );// truncation ok here - we can't have a bitvector with > 4GB bits.
 			_GenHeaderState( _rosHeader, pgn, nOuts, fAccept );
 		}
 		_rosHeader << "\n";
 	}
-	void	_GenStateDefinitions( ostream & _rosHeader )
+	// If _prgossUnits then the states are distributed evenly over those streams in state order, each templated state followed
+	//	by its explicit instantiations.
+	void	_GenStateDefinitions( ostream & _rosHeader, vector< ostringstream > * _prgossUnits = nullptr )
 	{
 		typename _TyNodeLookup::iterator	nit = m_pvtDfaCur->m_rDfa.m_nodeLookup.begin();
 		typename _TyNodeLookup::iterator	nitEnd = m_pvtDfaCur->m_rDfa.m_nodeLookup.end();
 		for ( ; nit != nitEnd; ++nit )
 		{
 			_TyGraphNode *	pgn = static_cast< _TyGraphNode * >( *nit );
+			if ( !_FEmitState( pgn ) )
+				continue;
 			int	nOuts = pgn->UChildren();	// We could record this earlier - like during both creation and optimization.
 			bool	fAccept = m_pvtDfaCur->m_rDfaCtxt.m_pssAccept->isbitset( (size_t)pgn->RElConst() ); // truncation ok here - we can't have a bitvector with > 4GB bits.
-			_GenImpState( _rosHeader, pgn, nOuts, fAccept );
+			if ( !_prgossUnits )
+			{
+				_GenImpState( _rosHeader, pgn, nOuts, fAccept );
+				continue;
+			}
+			ostream & rosUnit = (*_prgossUnits)[ _StCompactIndex( pgn ) * _prgossUnits->size() / m_nStatesTotal ];
+			_GenImpState( rosUnit, pgn, nOuts, fAccept );
+			if ( !m_pvtDfaCur->FDontTemplatizeStates() )
+			{
+				for ( typename vector< _TyString >::const_iterator cit = m_rgsInstantiateTraits.begin(); m_rgsInstantiateTraits.end() != cit; ++cit )
+				{
+					rosUnit << ( m_fConstantTables ? "template const _Ty" : "template _Ty" ) << m_sBaseStateName << ( pgn->RElConst() + m_stStart ) << " ";
+					if ( pgn == m_pvtDfaCur->m_rDfaCtxt.m_pgnStart )
+						rosUnit << m_pvtDfaCur->m_sStartStateName;
+					else
+						rosUnit << m_sBaseStateName << "_" << ( pgn->RElConst() + m_stStart );
+					rosUnit << "< " << *cit << " >;\n";
+				}
+			}
 		}
 		_rosHeader << "\n";
 	}
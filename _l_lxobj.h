@@ -27,6 +27,7 @@
 
 #include "_l_axion.h"
 #include "_l_state.h"
+#include "_l_cmptb.h"
 #include "_l_strm.h"
 
 #ifndef NDEBUG
@@ -55,13 +56,119 @@ public:
 template <class t_TyChar>
 struct _l_compare_input_with_range
 {
+  template <class t_TyScanChar>
   bool operator()(_l_transition<t_TyChar> const &_rrl,
-                  typename _l_transition<t_TyChar>::_TyUnsignedChar const &_rucr) const
+                  t_TyScanChar const &_rucr) const
   {
     return _rrl.m_last < _rucr;
   }
 };
 
+// _l_backtrack_memo: The ( state, position ) pairs from which the analyzer is known to find no further accept.
+// When a token attempt reads past its last accept and fails, every pair visited after that accept fails and the next attempt,
+//  which starts at the accept, would visit many of them again - for some rule sets this is quadratic in the input. With the
+//  memo the analyzer stops as soon as it reaches a known failing pair, as in Reps' "Maximal-munch" tokenization in linear
+//  time ( TOPLAS 1998 ).
+// The memo is a bitset with a row of state bits for each position from the start of the current attempt to the furthest
+//  position reached. Positions increase along an attempt, so the pairs visited before its last accept lie before the start of
+//  the next attempt - those rows are cleared then - and every bit remaining from the start of an attempt is a failing pair.
+//  Rows are reused as a ring and grow to fit the longest attempt - nothing is evicted so lexing is always linear.
+// States are identified by their compact table index ( see _l_cmptb.h ) so that a visit is a single bit test.
+// A start state that accepts the empty string breaks the invariant: the start state is then visited at the position of the
+//  attempt's last accept and the next attempt, which starts there, would find its first pair already marked as failing. Rule
+//  sets used with the memo must not match the empty string.
+struct _l_backtrack_memo
+{
+  vector< uint64_t > m_rgu64Bits; // m_nRows rows of m_nWordsRow words - position pos is row ( pos & ( m_nRows - 1 ) ).
+  size_t m_nWordsRow{0};
+  size_t m_nRows{0}; // A power of two.
+  vtyDataPosition m_posBase{0}; // The start of the current attempt - rows before this are zero.
+  vtyDataPosition m_posEnd{0}; // One beyond the last position with a row in use.
+  vtyDataPosition m_posNextMin{0}; // The last accept of the last attempt - an attempt starting before this clears the memo.
+  bool m_fEnabled{false};
+
+  bool FEnabled() const
+  {
+    return m_fEnabled;
+  }
+  void Init( bool _fEnable )
+  {
+    m_fEnabled = _fEnable;
+    if ( !_fEnable )
+    {
+      vector< uint64_t >().swap( m_rgu64Bits );
+      m_nWordsRow = m_nRows = 0;
+    }
+    Clear();
+  }
+  // Forget everything - positions are only meaningful within a single transport.
+  void Clear()
+  {
+    std::fill( m_rgu64Bits.begin(), m_rgu64Bits.end(), 0 );
+    m_posBase = m_posEnd = m_posNextMin = 0;
+  }
+  // An attempt starts at _pos - the rows before it are never visited again.
+  void BeginAttempt( vtyDataPosition _pos )
+  {
+    if ( _pos < m_posNextMin )
+      Clear(); // Repositioned before the last accept - the rows might hold pairs visited before that accept.
+    const vtyDataPosition kposClearEnd = (std::min)( _pos, m_posEnd );
+    for ( ; m_posBase < kposClearEnd; ++m_posBase )
+    {
+      uint64_t * pu64Row = m_rgu64Bits.data() + _IRow( m_posBase ) * m_nWordsRow;
+      std::fill( pu64Row, pu64Row + m_nWordsRow, 0 );
+    }
+    m_posBase = _pos;
+    if ( m_posEnd < _pos )
+      m_posEnd = _pos;
+  }
+  // Called at each state of an attempt after any accept has been recorded. Returns true if the pair is known to fail.
+  bool FVisit( size_t _idState, vtyDataPosition _pos )
+  {
+    Assert( _pos >= m_posBase );
+    const size_t kiWord = _idState / 64;
+    if ( ( kiWord >= m_nWordsRow ) || ( size_t( _pos - m_posBase ) >= m_nRows ) )
+      _Grow( kiWord + 1, size_t( _pos - m_posBase ) + 1 );
+    if ( _pos >= m_posEnd )
+      m_posEnd = _pos + 1;
+    uint64_t & ru64 = m_rgu64Bits[ _IRow( _pos ) * m_nWordsRow + kiWord ];
+    const uint64_t ku64Bit = uint64_t( 1 ) << ( _idState % 64 );
+    if ( ru64 & ku64Bit )
+      return true;
+    ru64 |= ku64Bit;
+    return false;
+  }
+  // The attempt has stopped with its last accept at _posLastAccept, or none.
+  void EndAttempt( vtyDataPosition _posLastAccept )
+  {
+    m_posNextMin = ( vkdpNullDataPosition == _posLastAccept ) ? m_posBase : _posLastAccept;
+  }
+protected:
+  size_t _IRow( vtyDataPosition _pos ) const
+  {
+    return size_t( _pos ) & ( m_nRows - 1 );
+  }
+  // Make room for _nWordsRow words per row and _nRows rows, copying the rows in use.
+  void _Grow( size_t _nWordsRow, size_t _nRows )
+  {
+    size_t nWordsRow = (std::max)( _nWordsRow, m_nWordsRow );
+    if ( nWordsRow > m_nWordsRow )
+      nWordsRow = (std::max)( nWordsRow, 2 * m_nWordsRow );
+    size_t nRows = (std::max)( m_nRows, size_t( 16 ) );
+    while ( nRows < _nRows )
+      nRows <<= 1;
+    vector< uint64_t > rgu64Bits( nRows * nWordsRow, 0 );
+    for ( vtyDataPosition pos = m_posBase; pos < m_posEnd; ++pos )
+    {
+      const uint64_t * pu64Row = m_rgu64Bits.data() + _IRow( pos ) * m_nWordsRow;
+      std::copy( pu64Row, pu64Row + m_nWordsRow, rgu64Bits.data() + ( size_t( pos ) & ( nRows - 1 ) ) * nWordsRow );
+    }
+    m_rgu64Bits.swap( rgu64Bits );
+    m_nWordsRow = nWordsRow;
+    m_nRows = nRows;
+  }
+};
+
 // _l_an_mostbase: Must be templatized by t_TyChar to keep other stuff simple as well.
 template < class t_TyChar >
 struct _l_an_mostbase
@@ -81,8 +188,28 @@ public:
   { 
     return m_paobCurToken;
   }
+  // States generated with egdoDispatchActionsById ( see _l_lxgen.h ) hold &_DispatchAction<tid> for their accept and trigger
+  //  actions so that they don't depend on the type of the lexical analyzer. The generated analyzer supplies the table of its
+  //  action methods indexed by token id - token ids without an action have a null entry.
+  void SetDispatchActions( const _TyPMFnAccept * _rgpmfnDispatchActions, size_t _nDispatchActions )
+  {
+    VerifyThrowSz( !_nDispatchActions || !!_rgpmfnDispatchActions, "Null dispatch table with [%zu] entries.", _nDispatchActions );
+    m_rgpmfnDispatchActions = _rgpmfnDispatchActions;
+    m_nDispatchActions = _nDispatchActions;
+  }
+  template < vtyTokenIdent t_kiTokenId >
+  bool _DispatchAction()
+  {
+    static_assert( t_kiTokenId >= 0 );
+    // A state may be used with an analyzer whose table doesn't cover its actions - e.g. before SetDispatchActions() is called:
+    VerifyThrowSz( size_t( t_kiTokenId ) < m_nDispatchActions, "Token id[%d] is beyond the dispatch table of [%zu] actions.", int( t_kiTokenId ), m_nDispatchActions );
+    VerifyThrowSz( !!m_rgpmfnDispatchActions[ t_kiTokenId ], "No dispatch action for token id[%d].", int( t_kiTokenId ) );
+    return (this->*m_rgpmfnDispatchActions[ t_kiTokenId ])();
+  }
 protected:
   _TyAxnObjBase * m_paobCurToken{nullptr}; // A pointer to the current token found by the lexang.
+  const _TyPMFnAccept * m_rgpmfnDispatchActions{nullptr};
+  size_t m_nDispatchActions{0};
 };
 
 template <class t_TyTraits, bool t_fSupportLookahead>
@@ -139,7 +266,15 @@ public:
   }
 };
 
-template < class t_TyTraits, bool t_fSupportLookahead, bool t_fSupportTriggers, bool t_fTrace >
+// t_TyCompactStateIndex: If not void then the analyzer moves through the compact state tables ( see _l_cmptb.h ) which
+//  use state indices of this type. The generator emits these tables and the analyzer type when asked.
+// t_fNulIsCharacter: If true then character 0 is an ordinary character and eof is the symbol s_kucEof which lies beyond every
+//  character - so it matches no transition and no default transition without any extra test in the scan. Otherwise 0 is eof
+//  and any 0 in the input ends the scan. The generator emits tables for the former when m_fNulIsCharacter is set.
+// t_fDefaultTransitions: If true then every state has the extra transition m_rgt[m_nt] which holds its default transition
+//  ( see _l_state_proto<>::PspDefault() ) and the analyzer follows it when no other transition matches. The generator emits
+//  this when any DFA has egdoDefaultTransitions - otherwise states have no such slot and a miss costs nothing extra.
+template < class t_TyTraits, bool t_fSupportLookahead, bool t_fSupportTriggers, bool t_fTrace, class t_TyCompactStateIndex, bool t_fNulIsCharacter, bool t_fDefaultTransitions >
 struct _l_analyzer : public _l_an_lookaheadbase< t_TyTraits, t_fSupportLookahead >
 {
 private:
@@ -172,6 +307,15 @@ public:
   static constexpr bool s_kfSupportLookahead = t_fSupportLookahead;
   static constexpr bool s_kfSupportTriggers = t_fSupportTriggers;
   static constexpr bool s_kfTrace = t_fTrace;
+  static constexpr bool s_kfCompactTables = !is_void_v< t_TyCompactStateIndex >;
+  static constexpr bool s_kfNulIsCharacter = t_fNulIsCharacter;
+  static constexpr bool s_kfDefaultTransitions = t_fDefaultTransitions;
+  // The type of m_ucCur - wide enough to hold s_kucEof as well as every character when 0 is a character.
+  typedef conditional_t< t_fNulIsCharacter, uint32_t, _TyUnsignedChar > _TyScanChar;
+  static_assert( sizeof( _TyUnsignedChar ) <= sizeof( _TyScanChar ), "The eof symbol must lie beyond every character." );
+  static constexpr _TyScanChar s_kucEof = t_fNulIsCharacter ? UINT32_MAX : 0;
+  typedef conditional_t< s_kfCompactTables, t_TyCompactStateIndex, uint32_t > _TyCompactStateIndex;
+  typedef _l_compact_tables< _TyChar, _TyCompactStateIndex > _TyCompactTables;
 
   _TyStream m_stream; // the stream within which is the transport object and user context, etc.
 
@@ -183,8 +327,14 @@ public:
   const _TyStateProto *m_pspCur{nullptr}; // Current state.
   vtyDataPosition m_posLastAccept{vkdpNullDataPosition};
   // The start of the current token is stored in the transport.
-  _TyUnsignedChar m_ucCur{0}; // The current character obtained from the transport.
+  _TyScanChar m_ucCur{s_kucEof}; // The current character obtained from the transport - s_kucEof at eof.
   _TyCompSearch m_compSearch;        // search object.
+  // Compact state tables - only used when s_kfCompactTables:
+  const _TyCompactTables * m_pctTables{nullptr};
+  _TyCompactStateIndex m_iStateCur{_TyCompactTables::s_kiNullState}; // The index of the current state - with the accept tag.
+  const _TyStateProto * m_pspStartCompact{nullptr}; // The last start state used - and its index - avoids searching for the start state index.
+  _TyCompactStateIndex m_iStateStartCompact{_TyCompactTables::s_kiNullState};
+  _l_backtrack_memo m_bmMemo; // Only used when enabled by SetBacktrackMemo().
 
   _l_analyzer() = delete;
   _l_analyzer(const _l_analyzer &) = delete;
@@ -202,16 +352,40 @@ public:
   void emplaceTransport( t_TysArgs&&... _args )
   {
     GetStream().emplaceTransport( std::forward< t_TysArgs >( _args )... );
+    m_bmMemo.Clear();
   }
   // Emplace a specific type of transport within a transport_var.
   template < class t_TyTransport, class... t_TysArgs >
   void emplaceVarTransport( t_TysArgs&&... _args )
   {
     GetStream().template emplaceVarTransport< t_TyTransport >( std::forward< t_TysArgs >( _args )... );
+    m_bmMemo.Clear();
   }
 
   using _TyBase::SetToken;
   using _TyBase::PGetToken;
+  void SetCompactTables( const _TyCompactTables * _pctTables )
+  {
+    static_assert( s_kfCompactTables, "The analyzer must be declared with a compact state index type to use compact tables." );
+    m_pctTables = _pctTables;
+    m_pspStartCompact = nullptr;
+    m_iStateStartCompact = _TyCompactTables::s_kiNullState;
+  }
+  const _TyCompactTables * PCompactTables() const
+  {
+    return m_pctTables;
+  }
+  // Remember the ( state, position ) pairs known to fail so that input after an accept is not rescanned - see
+  //  _l_backtrack_memo. Lexing is then linear in the input at the cost of a bit per state per position of the longest token
+  //  attempt. The tokens found are the same as without the memo. Use this for rule sets that _dfa_backtrack_analysis reports
+  //  as backtrack prone. Lookaheads and triggers make the outcome from a state depend on the path taken to it so they aren't supported.
+  //  The memo indexes states by their compact table index and so requires compact state tables.
+  void SetBacktrackMemo( bool _fEnable = true )
+  {
+    static_assert( !t_fSupportLookahead && !t_fSupportTriggers, "The backtrack memo isn't supported with lookaheads or triggers." );
+    static_assert( s_kfCompactTables, "The backtrack memo requires compact state tables." );
+    m_bmMemo.Init( _fEnable );
+  }
   _TyStream & GetStream()
   {
     return m_stream;
@@ -242,7 +416,7 @@ public:
   }
   vtyDataPosition GetCurrentPosition() const
   {
-    return GetStream().PosCurrent() - !!m_ucCur;
+    return GetStream().PosCurrent() - ( s_kucEof != m_ucCur );
   }
   // This clear the data out of all triggers and tokens. This should be used after input is given to the lex which it fails
   //  to regognize as a token. In that case the various triggers tha may have fired along the way will still contain data.
@@ -274,7 +448,7 @@ public:
   void _DoTrace(const char *_szFile, unsigned int _nLine, const char *_szFunction, const char *_szMesg, ...)
   {
     std::string strCur;
-    if ( !!m_ucCur )
+    if ( s_kucEof != m_ucCur )
     {
       if ((m_ucCur > 32) && (m_ucCur < 127))
         (void)FPrintfStdStrNoThrow(strCur, "%c (%llu)", (char)m_ucCur, uint64_t(m_ucCur) );
@@ -292,6 +466,11 @@ public:
       strMesg = _szMesg;
     }
 
+    if constexpr ( s_kfCompactTables )
+    {
+      if ( !!m_pctTables && ( _TyCompactTables::s_kiNullState != m_iStateCur ) )
+        m_pspCur = m_pctTables->PSPGetState( m_iStateCur );
+    }
     Assert(!!m_pspCur);
     if (s_kfTrace)
     {
@@ -302,9 +481,17 @@ public:
     }
   }
 
+  template < class t_TyTransportScan >
   void
-  _CheckAcceptState()
+  _CheckAcceptState( t_TyTransportScan const & _rtp )
   {
+    if constexpr ( s_kfCompactTables )
+    {
+      // The accept tag is on the index itself - only load the full state when we are accepting.
+      if ( !_TyCompactTables::FIsAcceptTagged( m_iStateCur ) )
+        return;
+      m_pspCur = m_pctTables->PSPGetState( m_iStateCur );
+    }
     if (m_pspCur->m_flAccept)
     {
       if (t_fSupportLookahead)
@@ -315,7 +502,7 @@ public:
         case kucAccept:
         {
           m_pspLastAccept = m_pspCur;
-          m_posLastAccept = GetCurrentPosition();
+          m_posLastAccept = _PosCurrent( _rtp );
         }
         break;
         case kucLookahead:
@@ -357,7 +544,7 @@ public:
         case kucLookaheadAccept:
         {
           m_pspLookaheadAccept = m_pspCur;
-          m_posLookaheadAccept = GetCurrentPosition();
+          m_posLookaheadAccept = _PosCurrent( _rtp );
         }
         break;
         case kucLookaheadAcceptAndAccept:
@@ -365,7 +552,7 @@ public:
           // We have an ambiguous state that is both an accepting state and a
           //	lookahead accepting state.
           m_pspLastAccept = m_pspLookaheadAccept = m_pspCur;
-          m_posLastAccept = m_posLookaheadAccept = GetCurrentPosition();
+          m_posLastAccept = m_posLookaheadAccept = _PosCurrent( _rtp );
         }
         break;
         case kucLookaheadAcceptAndLookahead:
@@ -399,7 +586,7 @@ public:
 
           // Record the lookahead accept:
           m_pspLookaheadAccept = m_pspCur;
-          m_posLookaheadAccept = GetCurrentPosition();
+          m_posLookaheadAccept = _PosCurrent( _rtp );
         }
         break;
         }
@@ -408,7 +595,7 @@ public:
       {
         LXOBJ_DOTRACE( "Accept found.");
         m_pspLastAccept = m_pspCur;
-        m_posLastAccept = GetCurrentPosition();
+        m_posLastAccept = _PosCurrent( _rtp );
       }
     }
   }
@@ -416,6 +603,18 @@ public:
   void _InitGetToken( const _TyStateProto *_pspStart )
   {
     m_pspCur = !_pspStart ? m_pspStart : _pspStart; // Start at the beginning again...
+    if constexpr ( s_kfCompactTables )
+    {
+      VerifyThrowSz( !!m_pctTables, "SetCompactTables() must be called before using an analyzer declared with compact tables." );
+      if ( m_pspCur != m_pspStartCompact )
+      {
+        m_iStateStartCompact = m_pctTables->IStateFindStart( m_pspCur );
+        VerifyThrowSz( _TyCompactTables::s_kiNullState != m_iStateStartCompact, "Start state isn't the start state of a DFA in the compact state tables." );
+        m_iStateStartCompact = m_pctTables->ITagState( m_iStateStartCompact );
+        m_pspStartCompact = m_pspCur;
+      }
+      m_iStateCur = m_iStateStartCompact;
+    }
     m_pspLastAccept = 0; // Regardless.
     if (t_fSupportLookahead)
       m_pspLookaheadAccept = 0;
@@ -426,6 +625,44 @@ public:
   // Caller can append a set of token ids to ignore while parsing. This will short-circuit things - not creating a token from the trigger data - just clearing the trigger data.
   // For instance an XML parser may be in "ignore comments and processing instructions" mode and then we would just skip those after recognizing them and move on to the next token if any.
   bool FGetToken( unique_ptr< _TyToken > & _rpuToken, vtyTokenIdent * _ptidIgnoreBegin = nullptr, vtyTokenIdent * _ptidIgnoreEnd = nullptr, const _TyStateProto *_pspStart = nullptr, bool _fThrowOnNoToken = false )
+  {
+    // For a _l_transport_var we dispatch on the type of transport once here rather than for every character.
+    if constexpr ( TFIsTransportVar_v< _TyTransport > )
+    {
+      return GetTransport().VisitTransport(
+        [this,&_rpuToken,_ptidIgnoreBegin,_ptidIgnoreEnd,_pspStart,_fThrowOnNoToken]( auto & _rtp )
+        {
+          return _FGetToken( _rtp, _rpuToken, _ptidIgnoreBegin, _ptidIgnoreEnd, _pspStart, _fThrowOnNoToken );
+        } );
+    }
+    else
+      return _FGetToken( GetTransport(), _rpuToken, _ptidIgnoreBegin, _ptidIgnoreEnd, _pspStart, _fThrowOnNoToken );
+  }
+
+  // Keep getting tokens until we hit eof or the callback method returns false.
+  // If we process things as much as possible - i.e. get tokens until we are supposed to or until the input is exhausted at the
+  //  start of a token - then we return true. If we encounter a state where we cannot move forward on input then we throw.
+  //  If an accept action rejects its token the data up to the accept is discarded and we continue.
+  template < class t_tyCallback >
+  bool FGetTokens( t_tyCallback _callback, const _TyStateProto *_pspStart = nullptr )
+  {
+    if constexpr ( TFIsTransportVar_v< _TyTransport > )
+    {
+      return GetTransport().VisitTransport(
+        [this,&_callback,_pspStart]( auto & _rtp )
+        {
+          return _FGetTokens( _rtp, _callback, _pspStart );
+        } );
+    }
+    else
+      return _FGetTokens( GetTransport(), _callback, _pspStart );
+  }
+
+protected:
+  // The implementations of FGetToken() and FGetTokens() - the scan reads characters directly from _rtp, which is the
+  //  transport or the transport active within a _l_transport_var.
+  template < class t_TyTransportScan >
+  bool _FGetToken( t_TyTransportScan & _rtp, unique_ptr< _TyToken > & _rpuToken, vtyTokenIdent * _ptidIgnoreBegin, vtyTokenIdent * _ptidIgnoreEnd, const _TyStateProto *_pspStart, bool _fThrowOnNoToken )
   {
 #ifdef LEXOBJ_STRICT
     {//B: We should be clear at the beginning of GetToken.
@@ -442,14 +679,11 @@ public:
       fIgnoredToken = false;
       _InitGetToken( _pspStart );
       Assert( GetStream().FAtTokenStart() ); // We shouldn't be mid-token.
-      _NextChar();
-      do
-      {
-        _CheckAcceptState();
-      } 
-      while ( _getnext() );
+      _NextChar( _rtp );
+      _ScanToken( _rtp );
 
-      if ( m_pspLastAccept )
+      const bool kfFoundAccept = !!m_pspLastAccept;
+      if ( kfFoundAccept )
       {
         _TyPMFnAccept pmfnAccept = m_pspLastAccept->PMFnGetAction();
         m_pspLastAccept = 0; // Regardless.
@@ -513,35 +747,32 @@ public:
         }
       }
       // No accepting state found. If we aren't at EOF then we should throw - or if we are at EOF and not at the start of a token.
-      if ( !fIgnoredToken && ( !!m_ucCur || !GetStream().FAtTokenStart() ) && _fThrowOnNoToken )
+      if ( !fIgnoredToken && ( ( s_kucEof != m_ucCur ) || !GetStream().FAtTokenStart() ) && _fThrowOnNoToken )
       {
         _TyStdStr strCurToken;
         GetStream().GetCurTokenString( strCurToken );
-        THROWNOTOKENFOUND(m_ucCur ? "Not at EOF, current token:[%s] m_ucCur[%c]" : "Not at EOF, current token:[%s]", strCurToken.c_str(), (char)m_ucCur );
+        THROWNOTOKENFOUND( ( s_kucEof != m_ucCur ) ? "Not at EOF, current token:[%s] m_ucCur[%c]" : "Not at EOF, current token:[%s]", strCurToken.c_str(), (char)m_ucCur );
       }
+      // Continue with the next document of a batch transport - discarding the rest of a document in which no token was found.
+      //  A token rejected by its accept action isn't a failure of the document - we just return false as without a batch transport.
+      if ( !fIgnoredToken && !kfFoundAccept && ( ( ( s_kucEof == m_ucCur ) && GetStream().FAtTokenStart() ) || !_fThrowOnNoToken ) )
+        fIgnoredToken = _FNextDocument( _rtp );
     }
     while( fIgnoredToken );
     return false;
   }
 
-  // Keep getting tokens until we hit eof or the callback method returns false.
-  // If we process things as much as possible - i.e. get tokens until we are supposed to, then we return true and _pspStateFailing is set to nullptr.
-  // If we encounter a state where we cannot move forward on input then we return false. The current state is then still set to the state from which we were unable to continue.
-  template < class t_tyCallback >
-  bool FGetTokens( t_tyCallback _callback, const _TyStateProto *_pspStart = nullptr )
+  template < class t_TyTransportScan, class t_tyCallback >
+  bool _FGetTokens( t_TyTransportScan & _rtp, t_tyCallback & _callback, const _TyStateProto *_pspStart )
   {
     Assert( GetStream().FAtTokenStart() ); // We shouldn't be mid-token.
     do
     {
       _InitGetToken( _pspStart );
       Assert( GetStream().FAtTokenStart() ); // We shouldn't be mid-token.
-      _NextChar();
+      _NextChar( _rtp );
       LXOBJ_DOTRACE("At start.");
-      do
-      {
-        _CheckAcceptState();
-      } 
-      while ( _getnext() );
+      _ScanToken( _rtp );
 
       if ( m_pspLastAccept )
       {
@@ -588,39 +819,139 @@ public:
       else
       {
         // No accepting state found. If we aren't at EOF then we should throw - or if we are at EOF and not at the start of a token.
-        if ( !!m_ucCur || !GetStream().FAtTokenStart() )
+        if ( ( s_kucEof != m_ucCur ) || !GetStream().FAtTokenStart() )
         {
           _TyStdStr strCurToken;
           GetStream().GetCurTokenString( strCurToken );
           THROWNOTOKENFOUND("Not at EOF, m_ucCur[%c] current token:[%s]", (char)m_ucCur, strCurToken.c_str() );
         }
-        return false;
+        if ( !_FNextDocument( _rtp ) )
+          return true; // All the input has been processed.
+        // else continue with the next document of a batch transport.
       }
-    } while (m_ucCur);
+    } while ( true ); // Reaching eof after a token doesn't mean the token ended there - we stop above when no token remains.
+  }
+  // At the end of a document of a _l_transport_batch, or when no token can be found in it, move to the next - the next token
+  //  then starts in the start state.
+  template < class t_TyTransportScan >
+  bool _FNextDocument( t_TyTransportScan & _rtp )
+  {
+    if constexpr ( TFIsTransportBatch_v< t_TyTransportScan > )
+    {
+      if ( _rtp.FNextDocument() )
+      {
+        LXOBJ_DOTRACE( "Moved to document[%zu].", _rtp.IDocument() );
+        return true;
+      }
+    }
+    return false;
   }
 
-protected:
-  void _NextChar()
+  // Move through the state machine recording accepts until there is no transition.
+  template < class t_TyTransportScan >
+  void _ScanToken( t_TyTransportScan & _rtp )
+  {
+    if ( !m_bmMemo.FEnabled() )
+    {
+      do
+      {
+        _CheckAcceptState( _rtp );
+      } 
+      while ( _getnext( _rtp ) );
+      return;
+    }
+    _ScanTokenMemo( _rtp );
+  }
+  template < class t_TyTransportScan >
+  void _ScanTokenMemo( t_TyTransportScan & _rtp )
+  {
+    if constexpr ( !t_fSupportLookahead && !t_fSupportTriggers && s_kfCompactTables )
+    {
+      m_bmMemo.BeginAttempt( _PosCurrent( _rtp ) );
+      do
+      {
+        _CheckAcceptState( _rtp );
+        if ( m_bmMemo.FVisit( _TyCompactTables::IStateUntag( m_iStateCur ), _PosCurrent( _rtp ) ) )
+        {
+          LXOBJ_DOTRACE( "Stopped at a state known to fail." );
+          break;
+        }
+      } 
+      while ( _getnext( _rtp ) );
+      m_bmMemo.EndAttempt( m_posLastAccept );
+    }
+  }
+  template < class t_TyTransportScan >
+  void _NextChar( t_TyTransportScan & _rtp )
+  {
+    if constexpr ( !t_fNulIsCharacter && TFIsTransportSentinel_v< t_TyTransportScan > )
+      m_ucCur = _TyUnsignedChar( _rtp.CGetCharSentinel() ); // The 0 after the data is eof - the sentinel is the only test.
+    else
+    {
+      _TyChar c;
+      m_ucCur = _rtp.FGetChar( c ) ? _TyScanChar( _TyUnsignedChar( c ) ) : s_kucEof;
+    }
+  }
+  // GetCurrentPosition() without going through the stream.
+  template < class t_TyTransportScan >
+  vtyDataPosition _PosCurrent( t_TyTransportScan const & _rtp ) const
   {
-    m_ucCur = 0;
-    (void)m_stream.FGetChar( m_ucCur );
+    return _rtp.PosCurrent() - ( s_kucEof != m_ucCur );
   }
-  void _execute_triggers()
+  void _execute_triggers( const _TyStateProto * _pspTrigger )
   {
     // Execute the triggers and then advance the state to the trigger state:
     _TyPMFnAccept *ppmfnTrigger = m_pspCur->PPMFnGetTriggerBegin();
     _TyPMFnAccept *ppmfnTriggerEnd = ppmfnTrigger + m_pspCur->m_nTriggers;
     // Change now - this allows the trigger to change the state if desired.
-    m_pspCur = m_pspCur->m_pspTrigger;
+    m_pspCur = _pspTrigger;
     for (; ppmfnTrigger != ppmfnTriggerEnd; ++ppmfnTrigger)
     {
       (void)(this->**ppmfnTrigger)();
     }
   }
 
+  // Move to the next state using the compact tables. Only m_iStateCur is maintained per character, m_pspCur is loaded
+  //  from the cold table when a state accepts, has a trigger, or when we stop.
+  template < class t_TyTransportScan >
+  bool _getnext_compact( t_TyTransportScan & _rtp )
+  {
+    _TyCompactStateIndex iStateNext = m_pctTables->IStateNext( m_iStateCur, m_ucCur, s_kucEof );
+    if ( _TyCompactTables::s_kiNullState != iStateNext )
+    {
+      m_iStateCur = iStateNext;
+      _NextChar( _rtp );
+      LXOBJ_DOTRACE( "Moved to state." );
+      return true;
+    }
+    m_pspCur = m_pctTables->PSPGetState( m_iStateCur );
+    if (t_fSupportTriggers && m_pctTables->FHasTrigger( m_iStateCur ))
+    {
+      // The trigger state comes from the compact tables - m_pspTrigger is null in constant tables ( see _l_lxgen.h ).
+      m_iStateCur = m_pctTables->IStateTrigger( m_iStateCur );
+      const _TyStateProto * pspTrigger = m_pctTables->PSPGetState( m_iStateCur );
+      if (m_pspCur->m_nTriggers)
+      {
+        _execute_triggers( pspTrigger );
+        Assert( m_pspCur == pspTrigger ); // Triggers don't move the analyzer - m_iStateCur is still the trigger state's index.
+        LXOBJ_DOTRACE( "Executed triggers." );
+      }
+      else
+      {
+        Assert( !!pspTrigger->m_nTriggers ); // We should be headed to a trigger state.
+        m_pspCur = pspTrigger; // Move to the trigger.
+      }
+      return true; // advanced the state.
+    }
+    return false;
+  }
+
   // Move to the next state - return true if we either advanced the state or both advanced the state and the stream.
-  bool _getnext()
+  template < class t_TyTransportScan >
+  bool _getnext( t_TyTransportScan & _rtp )
   {
+    if constexpr ( s_kfCompactTables )
+      return _getnext_compact( _rtp );
     switch (m_pspCur->m_nt)
     {
       case 0:
@@ -632,7 +963,7 @@ protected:
             m_ucCur >= m_pspCur->m_rgt[0].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[0].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -645,7 +976,7 @@ protected:
             m_ucCur >= m_pspCur->m_rgt[0].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[0].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -653,7 +984,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[1].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[1].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -666,7 +997,7 @@ protected:
             m_ucCur >= m_pspCur->m_rgt[0].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[0].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -674,7 +1005,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[1].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[1].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -682,7 +1013,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[2].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[2].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -695,7 +1026,7 @@ protected:
             m_ucCur >= m_pspCur->m_rgt[0].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[0].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -703,7 +1034,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[1].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[1].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -711,7 +1042,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[2].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[2].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -719,7 +1050,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[3].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[3].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -732,7 +1063,7 @@ protected:
             m_ucCur >= m_pspCur->m_rgt[0].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[0].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -740,7 +1071,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[1].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[1].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -748,7 +1079,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[2].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[2].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -756,7 +1087,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[3].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[3].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -764,7 +1095,7 @@ protected:
                 m_ucCur >= m_pspCur->m_rgt[4].m_first)
         {
           m_pspCur = m_pspCur->m_rgt[4].m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
@@ -778,16 +1109,28 @@ protected:
             lower_bound(m_pspCur->m_rgt,
                         m_pspCur->m_rgt + m_pspCur->m_nt,
                         m_ucCur, m_compSearch);
-        if ((m_ucCur >= ptLwr->m_first) &&
+        if ((ptLwr != m_pspCur->m_rgt + m_pspCur->m_nt) &&
+            (m_ucCur >= ptLwr->m_first) &&
             (m_ucCur <= ptLwr->m_last))
         {
           m_pspCur = ptLwr->m_psp;
-          _NextChar();
+          _NextChar( _rtp );
           LXOBJ_DOTRACE( "Moved to state." );
           return true;
         }
       }
     }
+    if constexpr ( t_fDefaultTransitions )
+    {
+      const _TyStateProto * pspDefault = m_pspCur->PspDefault();
+      if (!!pspDefault && (s_kucEof != m_ucCur)) // The default transition covers every character but not eof.
+      {
+        m_pspCur = pspDefault;
+        _NextChar( _rtp );
+        LXOBJ_DOTRACE( "Moved to default state." );
+        return true;
+      }
+    }
     if (t_fSupportTriggers)
     {
       // Then must check for a trigger transition:
@@ -795,7 +1138,7 @@ protected:
       {
         // Then have one - execute the triggers:
         Assert( !!m_pspCur->m_pspTrigger );
-        _execute_triggers();
+        _execute_triggers( m_pspCur->m_pspTrigger );
         LXOBJ_DOTRACE( "Executed triggers." );
         return true; // advanced the state.
       }
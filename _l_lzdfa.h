@@ -0,0 +1,439 @@
+#ifndef __L_LZDFA_H
+#define __L_LZDFA_H
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_lzdfa.h
+
+// Lazy (on-demand) DFA: Keeps the NFA and constructs DFA states only as the input reaches them.
+// This is for grammars whose DFA cannot be fully determinized within reasonable limits.
+// Constructed states live in a bounded cache - when the cache fills it is flushed completely ( as in RE2 ).
+//	If the cache is thrashing ( i.e. we are making too little progress between flushes ) then we abandon the
+//	cache for the remainder of the current match and simulate the NFA directly with state sets.
+// Accept selection matches _create_dfa: among the accepting NFA states in a DFA state the one with the lowest
+//	action id wins. As in _l_match::PszMatch() the first anti-accepting state reached is remembered in preference
+//	to later accepts but matching continues past it.
+// Triggers are followed when there is no character transition, as in _l_analyzer::_getnext(), and each trigger
+//	action present in the state reached by the trigger transition is passed to the caller's functor.
+// Lookahead isn't supported - construction throws if the NFA has lookaheads.
+// Each lazy DFA owns its closure cache and lends it to the NFA only while computing a closure - so several lazy DFAs may share an NFA
+//	and _create_dfa may be run on the NFA while they are alive ( but not concurrently with a match ).
+
+__REGEXP_BEGIN_NAMESPACE
+
+template < class t_TyNfa >
+class _lazy_dfa
+{
+private:
+  typedef _lazy_dfa< t_TyNfa > _TyThis;
+
+public:
+  typedef t_TyNfa _TyNfa;
+  typedef typename _TyNfa::_TyContext _TyNfaCtxt;
+  typedef typename _TyNfa::_TyAllocator _TyAllocator;
+  typedef typename _TyNfa::_TyChar _TyChar;
+  typedef typename _TyNfa::_TyUnsignedChar _TyUnsignedChar;
+  typedef typename _TyNfa::_TyRange _TyRange;
+  typedef typename _TyNfa::_TyRangeEl _TyRangeEl;
+  typedef typename _TyNfa::_TyState _TyState;
+  typedef typename _TyNfa::_TySetStates _TySetStates;
+  typedef typename _TyNfa::_TyAcceptAction _TyAcceptAction;
+  typedef _fa_base< _TyChar > _TyFaBase;
+
+  typedef int32_t _TyLazyState;
+  static constexpr _TyLazyState s_klsUnknown = -1;
+  static constexpr _TyLazyState s_klsDead = -2;
+
+  // If we flush the cache having processed fewer than this many characters per cached state since the last flush then the cache is thrashing.
+  static const size_t s_knThrashCharsPerState = 10;
+
+protected:
+  typedef _swap_object< _TySetStates > _TySwapSS;
+  typedef typename _Alloc_traits< typename unordered_map< _TySwapSS, _TyLazyState >::value_type, _TyAllocator >::allocator_type _TyLookupSSAlloc;
+  typedef unordered_map< _TySwapSS, _TyLazyState, hash< _TySwapSS >, equal_to< _TySwapSS >, _TyLookupSSAlloc > _TyLookupSS;
+  typedef typename _Alloc_traits< typename vector< const _TyAcceptAction * >::value_type, _TyAllocator >::allocator_type _TyRgPAcceptActionAlloc;
+  typedef vector< const _TyAcceptAction *, _TyRgPAcceptActionAlloc > _TyRgPAcceptAction;
+
+  struct _lazy_state
+  {
+    const _TySetStates * m_pss{nullptr}; // Points at the key in m_ssLookup.
+    const _TyAcceptAction * m_paaAccept{nullptr}; // The winning accept action for this state - null if non-accepting.
+    _TyRgPAcceptAction m_rgpaaTriggers; // Trigger actions present in this state - fired when this state is reached via a trigger transition.
+    _TyLazyState m_lsTrigger{s_klsUnknown}; // The state reached by a trigger transition - computed on demand.
+
+    _lazy_state( _TyAllocator const & _rAlloc )
+      : m_rgpaaTriggers( _rAlloc )
+    {
+    }
+  };
+  typedef typename _Alloc_traits< typename deque< _lazy_state >::value_type, _TyAllocator >::allocator_type _TyRgStatesAlloc;
+  typedef deque< _lazy_state, _TyRgStatesAlloc > _TyRgStates;
+  typedef typename _Alloc_traits< typename vector< _TyLazyState >::value_type, _TyAllocator >::allocator_type _TyRgTransitionsAlloc;
+  typedef vector< _TyLazyState, _TyRgTransitionsAlloc > _TyRgTransitions;
+  typedef typename _Alloc_traits< typename vector< _TyRange >::value_type, _TyAllocator >::allocator_type _TyRgRangesAlloc;
+  typedef vector< _TyRange, _TyRgRangesAlloc > _TyRgRanges;
+  typedef typename _Alloc_traits< char, _TyAllocator >::allocator_type _TyClosureCacheAlloc;
+  typedef vector< char, _TyClosureCacheAlloc > _TyClosureCache;
+
+  // Lend our closure cache to the NFA for the duration of a closure computation:
+  struct _closure_cache_scope
+  {
+    _TyThis & m_rThis;
+    char * m_cpClosureCache;
+    _closure_cache_scope( _TyThis & _rThis )
+      : m_rThis( _rThis )
+      , m_cpClosureCache( _rThis.m_rgcClosureCache.data() )
+    {
+      m_rThis.m_rNfa.SwapClosureCache( m_cpClosureCache, m_rThis.m_ssClosureComputed );
+    }
+    ~_closure_cache_scope()
+    {
+      m_rThis.m_rNfa.SwapClosureCache( m_cpClosureCache, m_rThis.m_ssClosureComputed );
+    }
+  };
+
+  _TyNfa & m_rNfa;
+  _TyNfaCtxt & m_rNfaCtxt;
+  size_t m_nMaxStates; // Maximum number of states in the cache.
+  _TySetStates m_ssAccepting; // The accepting states of the NFA.
+  _TySetStates m_ssStart; // The closure of the NFA start state.
+  _TyRgRanges m_rgrngChars; // The character ranges of the NFA alphabet - an index into this is the column in m_rgTransitions.
+  _TyRange m_rngTriggers; // Covers all trigger transitions - empty if there are none.
+  _TyLookupSS m_ssLookup;
+  _TyRgStates m_rgStates;
+  _TyRgTransitions m_rgTransitions; // m_rgStates.size() x m_rgrngChars.size().
+  _TyLazyState m_lsStart{s_klsUnknown};
+  // Our own closure cache - the NFA's cache is left free so that any number of lazy DFAs and _create_dfa may share the NFA:
+  _TySetStates m_ssClosureComputed;
+  _TyClosureCache m_rgcClosureCache;
+  // Scratch state sets - these keep NFA simulation and state computation from allocating per character:
+  _TySetStates m_ssCur; // NFA simulation current state.
+  _TySetStates m_ssNext; // NFA simulation next state - swapped with m_ssCur.
+  _TySetStates m_ssMove;
+  _TySetStates m_ssStartCopy; // ComputeSetMoveStates() clears the start set so we pass it a copy.
+  _TyRgPAcceptAction m_rgpaaSimTriggers; // NFA simulation trigger actions.
+
+  // Statistics:
+  size_t m_nCharsSinceFlush{0};
+  size_t m_nFlushes{0};
+  size_t m_nNfaSimulations{0};
+
+public:
+  _lazy_dfa( _TyNfa & _rNfa, _TyNfaCtxt & _rNfaCtxt, size_t _nMaxStates = 10000 )
+    : m_rNfa( _rNfa )
+    , m_rNfaCtxt( _rNfaCtxt )
+    , m_nMaxStates( (std::max)( _nMaxStates, size_t( 2 ) ) )
+    , m_ssAccepting( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_ssStart( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_rgrngChars( _rNfa.get_allocator() )
+    , m_ssLookup( 0, typename _TyLookupSS::hasher(), typename _TyLookupSS::key_equal(), _rNfa.get_allocator() )
+    , m_rgStates( _rNfa.get_allocator() )
+    , m_rgTransitions( _rNfa.get_allocator() )
+    , m_ssClosureComputed( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_rgcClosureCache( _rNfa.get_allocator() )
+    , m_ssCur( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_ssNext( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_ssMove( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_ssStartCopy( (size_t)_rNfa.NStates(), _rNfa.get_allocator() )
+    , m_rgpaaSimTriggers( _rNfa.get_allocator() )
+  {
+    VerifyThrowSz( !m_rNfa.m_fHasLookaheads, "_lazy_dfa doesn't support lookahead." );
+    VerifyThrowSz( (size_t)(numeric_limits< _TyLazyState >::max)() > m_nMaxStates, "_nMaxStates[%zu] is too large.", m_nMaxStates );
+    m_ssAccepting.clear();
+    m_rNfaCtxt.GetAcceptingNodeSet( m_ssAccepting );
+
+    // Sort the alphabet into character ranges and the trigger range - unsatisfiable transitions are never taken:
+    for ( typename _TyNfa::_TyAlphabet::const_iterator itAlpha = m_rNfa.m_setAlphabet.begin(); m_rNfa.m_setAlphabet.end() != itAlpha; ++itAlpha )
+    {
+      if ( itAlpha->empty() )
+        continue;
+      if ( itAlpha->first >= _TyFaBase::ms_kreUnsatisfiableStart )
+        continue;
+      if ( itAlpha->first >= _TyFaBase::ms_kreTriggerStart )
+      {
+        if ( m_rngTriggers.empty() )
+          m_rngTriggers = *itAlpha;
+        else
+          m_rngTriggers.second = itAlpha->second;
+        continue;
+      }
+      m_rgrngChars.push_back( *itAlpha );
+    }
+
+    m_ssClosureComputed.clear();
+    m_rgcClosureCache.resize( m_ssClosureComputed.size_bytes() * (size_t)m_rNfa.NStates(), 0 );
+    _closure_cache_scope ccs( *this );
+    m_ssStart.clear();
+    m_rNfa.Closure( m_rNfaCtxt.m_pgnStart, m_ssStart, true );
+  }
+  _lazy_dfa( _lazy_dfa const & ) = delete;
+  _lazy_dfa & operator =( _lazy_dfa const & ) = delete;
+
+  size_t NStatesCached() const
+  {
+    return m_rgStates.size();
+  }
+  size_t NFlushes() const
+  {
+    return m_nFlushes;
+  }
+  size_t NNfaSimulations() const
+  {
+    return m_nNfaSimulations;
+  }
+  void ClearCache()
+  {
+    m_ssLookup.clear();
+    m_rgStates.clear();
+    m_rgTransitions.clear();
+    m_lsStart = s_klsUnknown;
+    m_nCharsSinceFlush = 0;
+  }
+
+  // Match in maximal munch fashion from the start of [_pchBegin,_pchBegin+_nchLen) - as _l_match::PszMatch().
+  // Returns the end of the token or nullptr if no token was matched. *_ppaaAccept receives the accept action ( which contains the action object and so the token id ).
+  // _rftTrigger( _TyAcceptAction const & _raaTrigger, const _TyChar * _pchCur ) is called for each trigger action as triggers are followed.
+  template < class t_TyFTrigger >
+  const _TyChar * PszMatch( const _TyChar * _pchBegin, size_t _nchLen, const _TyAcceptAction ** _ppaaAccept, t_TyFTrigger && _rftTrigger )
+  {
+    const _TyChar * pchCur = _pchBegin;
+    const _TyChar * const pchEnd = _pchBegin + _nchLen;
+    const _TyAcceptAction * paaLastAccept = nullptr;
+    const _TyChar * pchLastAccept = nullptr;
+    auto lambdaCheckAccept = [&paaLastAccept,&pchLastAccept,&pchCur]( const _TyAcceptAction * _paa )
+    {
+      // We want the first encountered anti-accepting state and the last encountered accepting state:
+      if ( !_paa )
+        return;
+      if ( ( e_aatAntiAccepting != _paa->m_eaatType ) || !paaLastAccept || ( e_aatAntiAccepting != paaLastAccept->m_eaatType ) )
+      {
+        paaLastAccept = _paa;
+        pchLastAccept = pchCur;
+      }
+    };
+
+    if ( s_klsUnknown == m_lsStart )
+      m_lsStart = _LsAddState( m_ssStart );
+    _TyLazyState lsCur = m_lsStart;
+    lambdaCheckAccept( m_rgStates[ (size_t)lsCur ].m_paaAccept );
+    // NFA simulation - only used if the cache is thrashing. m_ssCur contains the current state:
+    bool fNfaSimulation = false;
+
+    for ( ; pchEnd != pchCur; )
+    {
+      if ( !fNfaSimulation )
+      {
+        const _TyChar * pchTrigger = pchCur;
+        size_t stAlpha = _STAlphaIndex( *pchCur );
+        _TyLazyState lsNext = s_klsDead;
+        if ( m_rgrngChars.size() != stAlpha )
+        {
+          lsNext = m_rgTransitions[ (size_t)lsCur * m_rgrngChars.size() + stAlpha ];
+          if ( s_klsUnknown == lsNext )
+          {
+            if ( !_FComputeNext( lsCur, &m_rgrngChars[ stAlpha ], stAlpha, lsNext ) )
+            {
+              fNfaSimulation = true;
+              ++m_nNfaSimulations;
+              continue; // m_ssCur contains the current state - redo this char in NFA simulation.
+            }
+          }
+        }
+        if ( s_klsDead != lsNext )
+        {
+          ++pchCur;
+          ++m_nCharsSinceFlush;
+        }
+        else
+        {
+          // No character transition - check for a trigger transition:
+          lsNext = m_rgStates[ (size_t)lsCur ].m_lsTrigger;
+          if ( s_klsUnknown == lsNext )
+          {
+            if ( !_FComputeNext( lsCur, nullptr, 0, lsNext ) )
+            {
+              fNfaSimulation = true;
+              ++m_nNfaSimulations;
+              continue;
+            }
+          }
+          if ( s_klsDead == lsNext )
+            break;
+          _FireTriggers( m_rgStates[ (size_t)lsNext ].m_rgpaaTriggers, pchTrigger, _rftTrigger );
+        }
+        lsCur = lsNext;
+        lambdaCheckAccept( m_rgStates[ (size_t)lsCur ].m_paaAccept );
+      }
+      else
+      {
+        _closure_cache_scope ccs( *this );
+        m_ssNext.clear();
+        _ComputeMoveClosure( m_ssCur, _TyRange( (_TyUnsignedChar)*pchCur, (_TyUnsignedChar)*pchCur ), m_ssNext );
+        const _TyChar * pchTrigger = pchCur;
+        m_rgpaaSimTriggers.clear();
+        if ( !m_ssNext.empty() )
+          ++pchCur;
+        else
+        {
+          if ( m_rngTriggers.empty() )
+            break;
+          _ComputeMoveClosure( m_ssCur, m_rngTriggers, m_ssNext );
+          if ( m_ssNext.empty() )
+            break;
+          (void)_PAAGetAccept( m_ssNext, m_rgpaaSimTriggers );
+          _FireTriggers( m_rgpaaSimTriggers, pchTrigger, _rftTrigger );
+          m_rgpaaSimTriggers.clear();
+        }
+        m_ssCur.swap( m_ssNext );
+        lambdaCheckAccept( _PAAGetAccept( m_ssCur, m_rgpaaSimTriggers ) ); // triggers are only fired on arrival via a trigger transition.
+      }
+    }
+    if ( !!_ppaaAccept )
+      *_ppaaAccept = paaLastAccept;
+    if ( !paaLastAccept || ( e_aatAntiAccepting == paaLastAccept->m_eaatType ) )
+      return _ppaaAccept ? pchLastAccept : nullptr;
+    return pchLastAccept;
+  }
+  const _TyChar * PszMatch( const _TyChar * _pchBegin, size_t _nchLen, const _TyAcceptAction ** _ppaaAccept = nullptr )
+  {
+    return PszMatch( _pchBegin, _nchLen, _ppaaAccept, []( _TyAcceptAction const &, const _TyChar * ) {} );
+  }
+
+protected:
+  template < class t_TyFTrigger >
+  static void _FireTriggers( _TyRgPAcceptAction const & _rrgpaa, const _TyChar * _pchCur, t_TyFTrigger && _rftTrigger )
+  {
+    for ( const _TyAcceptAction * paa : _rrgpaa )
+      _rftTrigger( *paa, _pchCur );
+  }
+  size_t _STAlphaIndex( _TyChar _ch ) const
+  {
+    _TyRange rngCh( (_TyUnsignedChar)_ch, (_TyUnsignedChar)_ch );
+    typename _TyRgRanges::const_iterator it = lower_bound( m_rgrngChars.begin(), m_rgrngChars.end(), rngCh );
+    if ( ( m_rgrngChars.end() == it ) || !it->contains( rngCh.first ) )
+      return m_rgrngChars.size();
+    return it - m_rgrngChars.begin();
+  }
+
+  // Find the winning accept action for _rss and the triggers present in it - this mirrors _create_dfa::_NewDfaState().
+  const _TyAcceptAction * _PAAGetAccept( _TySetStates const & _rss, _TyRgPAcceptAction & _rrgpaaTriggers ) const
+  {
+    const _TyAcceptAction * paaAccept = nullptr;
+    for ( size_t stAccept = m_ssAccepting.FirstIntersection( _rss ); m_ssAccepting.size() != stAccept; stAccept = m_ssAccepting.NextIntersection( _rss, stAccept ) )
+    {
+      typename _TyNfa::_TySetAcceptStates::const_iterator it = m_rNfa.m_pSetAcceptStates->find( (_TyState)stAccept );
+      Assert( m_rNfa.m_pSetAcceptStates->end() != it );
+      _TyAcceptAction const & raa = it->second;
+      switch ( raa.m_eaatType )
+      {
+      case e_aatAccept:
+      case e_aatAntiAccepting:
+        if ( !paaAccept || ( raa.m_aiAction < paaAccept->m_aiAction ) )
+          paaAccept = &raa;
+      break;
+      case e_aatTrigger:
+        _rrgpaaTriggers.push_back( &raa );
+      break;
+      default:
+        Assert( 0 ); // lookahead is rejected at construction.
+      break;
+      }
+    }
+    return paaAccept;
+  }
+
+  _TyLazyState _LsAddState( _TySetStates const & _rss )
+  {
+    Assert( m_rgStates.size() < m_nMaxStates );
+    _TySetStates ssTemp( _rss ); // gcc doesn't like the inline temporary.
+    typename _TyLookupSS::value_type vtInsert( ssTemp, (_TyLazyState)m_rgStates.size() );
+    pair< typename _TyLookupSS::iterator, bool > pibInserted = m_ssLookup.insert( vtInsert );
+    Assert( pibInserted.second );
+    m_rgStates.emplace_back( m_rNfa.get_allocator() );
+    _lazy_state & rls = m_rgStates.back();
+    rls.m_pss = &pibInserted.first->first.RObject();
+    rls.m_paaAccept = _PAAGetAccept( *rls.m_pss, rls.m_rgpaaTriggers );
+    m_rgTransitions.resize( m_rgStates.size() * m_rgrngChars.size(), s_klsUnknown );
+    return pibInserted.first->second;
+  }
+
+  // Set _rssNext to the closure of the states reached from _rssCur on _rrng. _rssNext must be empty on entry and the closure cache must be lent to the NFA.
+  void _ComputeMoveClosure( _TySetStates const & _rssCur, _TyRange const & _rrng, _TySetStates & _rssNext )
+  {
+    Assert( _rssNext.empty() );
+    if ( _rssCur.empty() )
+      return;
+    m_ssStartCopy.clear();
+    m_ssStartCopy |= _rssCur;
+    m_ssMove.clear();
+    m_rNfa.ComputeSetMoveStates( m_ssStartCopy, _rrng, m_ssMove );
+    m_rNfa.ComputeSetClosure( m_ssMove, _rssNext );
+  }
+
+  // Compute the state reached from _lsCur on _prng ( or on the trigger range if _prng is null ) and record it in the cache.
+  // Returns false if the cache is thrashing - in that case m_ssCur is set to the state set of _lsCur so the caller can continue with NFA simulation.
+  // Note that this may flush the cache - in which case _lsCur is re-added and remapped.
+  bool _FComputeNext( _TyLazyState & _rlsCur, const _TyRange * _prng, size_t _stAlpha, _TyLazyState & _rlsNext )
+  {
+    _TySetStates & rssNext = m_ssNext; // m_ssNext is otherwise only used by NFA simulation.
+    rssNext.clear();
+    if ( !!_prng || !m_rngTriggers.empty() )
+    {
+      _closure_cache_scope ccs( *this );
+      _ComputeMoveClosure( *m_rgStates[ (size_t)_rlsCur ].m_pss, _prng ? *_prng : m_rngTriggers, rssNext );
+    }
+    if ( rssNext.empty() )
+      _rlsNext = s_klsDead;
+    else
+    {
+      _TySwapSS sossLookup( rssNext ); // takes possession of bitvec inside rssNext.
+      typename _TyLookupSS::iterator itLookup = m_ssLookup.find( sossLookup );
+      rssNext.swap( sossLookup ); // Swap back.
+      if ( m_ssLookup.end() != itLookup )
+        _rlsNext = itLookup->second;
+      else
+      {
+        if ( m_rgStates.size() == m_nMaxStates )
+        {
+          // Flush the cache - remember the current state's set first:
+          m_ssCur.clear();
+          m_ssCur |= *m_rgStates[ (size_t)_rlsCur ].m_pss;
+          bool fThrashing = m_nCharsSinceFlush < ( m_nMaxStates * s_knThrashCharsPerState );
+          ClearCache();
+          ++m_nFlushes;
+          if ( fThrashing )
+            return false;
+          _rlsCur = _LsAddState( m_ssCur );
+        }
+        _rlsNext = _LsAddState( rssNext );
+      }
+    }
+    if ( !!_prng )
+      m_rgTransitions[ (size_t)_rlsCur * m_rgrngChars.size() + _stAlpha ] = _rlsNext;
+    else
+      m_rgStates[ (size_t)_rlsCur ].m_lsTrigger = _rlsNext;
+    return true;
+  }
+};
+
+// Determinize _rNfa into _rDfa unless the DFA would have more than _nMaxDfaStates states - in that case create a _lazy_dfa
+//	for _rNfa in _rupLazyDfa instead and return false. _rDfa and _rDfaCtxt are then incomplete and should be discarded. The
+//	NFA and its context must outlive the lazy DFA.
+template < class t_TyNfa, class t_TyDfa >
+bool FCreateDfaOrLazy( t_TyNfa & _rNfa, typename t_TyNfa::_TyContext & _rNfaCtxt, t_TyDfa & _rDfa, typename t_TyDfa::_TyContext & _rDfaCtxt,
+  size_t _nMaxDfaStates, unique_ptr< _lazy_dfa< t_TyNfa > > & _rupLazyDfa, bool _fCreateDeadState = true, size_t _nThreads = 1 )
+{
+  _create_dfa< t_TyNfa, t_TyDfa > cdfa( _rNfa, _rNfaCtxt, _rDfa, _rDfaCtxt, _fCreateDeadState, 3000, _nThreads );
+  cdfa.SetDfaNodeLimit( _nMaxDfaStates );
+  if ( cdfa.create() )
+    return true;
+  _rupLazyDfa = make_unique< _lazy_dfa< t_TyNfa > >( _rNfa, _rNfaCtxt );
+  return false;
+}
+
+__REGEXP_END_NAMESPACE
+
+#endif //__L_LZDFA_H
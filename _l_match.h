@@ -14,18 +14,21 @@
 // As such we don't need an object because there are no triggers and no actions that will be executed( even if there are actions in the state machine).
 // We will follow triggers appropriately if t_kfFollowTriggers is true, otherwise triggers are not followed. Regardless the trigger action will not be called if present.
 // We do not support lookahead for this.
+// If t_kfDefaultTransitions is true then the states must have been generated with default transitions ( egdoDefaultTransitions ) and we follow
+//  a state's default transition on any character that matches none of its transitions - see _l_state_proto<>::PspDefault().
 
 #include "_l_state.h"
 
 __LEXOBJ_BEGIN_NAMESPACE
 
-template < class t_TyChar, bool t_kfFollowTriggers = false >
+template < class t_TyChar, bool t_kfFollowTriggers = false, bool t_kfDefaultTransitions = false >
 class _l_match
 {
   typedef _l_match _TyThis;
 public:
   typedef t_TyChar _TyChar;
   static constexpr bool s_kfFollowTriggers = t_kfFollowTriggers;
+  static constexpr bool s_kfDefaultTransitions = t_kfDefaultTransitions;
   typedef _l_state_proto< _TyChar > _TyStateProto;
   typedef _l_transition< _TyChar > _TyTransition;
 
@@ -50,9 +53,13 @@ public:
       _TyChar chCur = *pchCur;
       for ( ; ( ptrEnd != ptrCur ) && !( ( chCur <= ptrCur->m_last ) && ( chCur >= ptrCur->m_first ) ); ++ptrCur )
         ;
-      if ( ptrEnd == ptrCur )
+      if ( ptrEnd != ptrCur )
+        pspCur = ptrCur->m_psp;
+      else
+      if ( const _TyStateProto * pspDefault = _PspDefault( pspCur ) )
+        pspCur = pspDefault;
+      else
         break; // no transition on this character from this state and we aren't following triggers.
-      pspCur = ptrCur->m_psp;
       if ( pspCur->m_flAccept )
       {
         // We want the first encountered anti-accepting state and the last encountered accepting state.
@@ -88,6 +95,12 @@ public:
       _TyChar chCur = *pchCur;
       for ( ; ( ptrEnd != ptrCur ) && !( ( chCur <= ptrCur->m_last ) && ( chCur >= ptrCur->m_first ) ); ++ptrCur )
         ;
+      if ( ( ptrEnd == ptrCur ) && !!_PspDefault( pspCur ) )
+      {
+        ++pchCur; // we ate a char.
+        pspCur = _PspDefault( pspCur );
+      }
+      else
       if ( ptrEnd == ptrCur )
       {
         if ( pspCur->m_pspTrigger ) // Follow a trigger transition if there is one - in this case no character is eaten.
@@ -112,6 +125,14 @@ public:
       return _ppspLastAccept ? pchLastAccept : nullptr; // return as far as we got until we failed unless this is the only way the caller knows about failure.
     return pchLastAccept; // accepted 
   }
+protected:
+  static const _TyStateProto * _PspDefault( const _TyStateProto * _psp )
+  {
+    if constexpr ( s_kfDefaultTransitions )
+      return _psp->PspDefault();
+    else
+      return nullptr;
+  }
 };
 
 __LEXOBJ_END_NAMESPACE
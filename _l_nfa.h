@@ -76,6 +76,10 @@ public:
 	// Friends:
 	template < class t__TyNfa, class t__TyDfa >
 	friend struct _create_dfa;
+	template < class t__TyNfa >
+	friend class _lazy_dfa;
+	template < class t__TyNfa, class t__TyDfa >
+	friend class _dfa_cache;
 	friend class _nfa_context< t_TyChar, t_TyAllocator >;
 
 	typedef t_TyChar _TyChar;
@@ -212,6 +216,14 @@ public:
 		m_ssClosureComputed.swap( ssComputed );
 	}
 
+	// Exchange the closure cache with one owned by the caller. This allows a long lived client ( i.e. _lazy_dfa ) to keep its own
+	//	cache and only lend it to the NFA while computing closures - so that the NFA's cache remains free for _create_dfa, etc.
+	void	SwapClosureCache( char *& _rcpClosureCache, _TySetStates & _rssClosureComputed )
+	{
+		std::swap( m_cpClosureCache, _rcpClosureCache );
+		m_ssClosureComputed.swap( _rssClosureComputed );
+	}
+
 	char *	PCGetClosureCache( size_type _st )
 	{
 		return m_cpClosureCache + m_ssClosureComputed.size_bytes() * _st;
@@ -65,12 +65,19 @@ struct _l_state_proto
   unsigned short m_usOffsetTriggers;
   vtyTokenIdent m_tidAccept; // This is the token id of any accept action associated with this state or vktidInvalidIdToken.
   _TyTransition m_rgt[7]; // You can access the transitions - i.e. it is ok to access them without using an accessor - 7 is just a random number - more or less.
+                          // When generated with default transitions m_rgt[m_nt] is an extra transition whose m_psp is the default, see PspDefault().
 private: // Variable length structure - use accessors.
   _TyPMFnAccept m_pmfnAccept;
   vtyActionIdent m_aiLookahead;             // The associated lookahead action id.
   vtyLookaheadVector m_rgValidLookahead[2]; // bit vector for valid associated lookahead actions.
   _TyPMFnAccept m_rgpmfnTriggers[7];        // Array of pointers to trigger functions - there can be more or less than 7 - random number.
 public:
+  // The transition on any character ( other than eof ) not matched by m_rgt[], or null. Only states generated with default
+  //  transitions ( egdoDefaultTransitions ) have this, see _l_analyzer<>::s_kfDefaultTransitions.
+  const _l_state_proto * PspDefault() const
+  {
+    return m_rgt[m_nt].m_psp;
+  }
   _TyPMFnAccept PMFnGetAction() const
   {
     Assert(m_flAccept);
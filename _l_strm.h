@@ -17,6 +17,12 @@
 #include "_l_ns.h"
 #include "_l_types.h"
 #include "_l_transport.h"
+#include "_l_trblk.h"
+#include "_l_trwmp.h"
+#include "_l_trzip.h"
+#include "_l_triov.h"
+#include "_l_trutf.h"
+#include "_l_trbat.h"
 
 __LEXOBJ_BEGIN_NAMESPACE
 
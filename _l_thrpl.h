@@ -0,0 +1,167 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_thrpl.h
+// Simple fixed-size thread pool used by the DFA construction and optimization phases of the generator.
+// dbien
+// 19OCT2026
+
+// The only operation is ParallelFor() - the calling thread participates in the work and the call
+//  doesn't return until every item has been processed. Items are handed out dynamically so the functor must
+//  only write state owned by the item it was given - callers then merge the results sequentially in a fixed
+//  order so that output is deterministic regardless of the number of threads used.
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <exception>
+
+__REGEXP_BEGIN_NAMESPACE
+
+class _l_thread_pool
+{
+  typedef _l_thread_pool _TyThis;
+public:
+  typedef std::function< void( size_t ) > _TyFunctionItem;
+
+  // _nThreads includes the calling thread - so 1 means no worker threads are created.
+  // 0 means use std::thread::hardware_concurrency().
+  _l_thread_pool( size_t _nThreads )
+  {
+    if ( !_nThreads )
+      _nThreads = (std::max)( 1u, std::thread::hardware_concurrency() );
+    m_rgThreads.reserve( _nThreads - 1 );
+    try
+    {
+      while ( m_rgThreads.size() < _nThreads - 1 )
+        m_rgThreads.emplace_back( &_TyThis::_WorkerThread, this );
+    }
+    catch( ... )
+    {
+      _Shutdown();
+      throw;
+    }
+  }
+  ~_l_thread_pool()
+  {
+    _Shutdown();
+  }
+  _l_thread_pool( _l_thread_pool const & ) = delete;
+  _l_thread_pool & operator =( _l_thread_pool const & ) = delete;
+
+  size_t NThreads() const
+  {
+    return m_rgThreads.size() + 1;
+  }
+
+  // Call _rfn( stItem ) for each stItem in [0,_nItems). Returns when all items have been processed.
+  // The first exception thrown by any item is rethrown here - once an exception is thrown no further items are started.
+  template < class t_TyFunctor >
+  void ParallelFor( size_t _nItems, t_TyFunctor && _rfn )
+  {
+    if ( m_rgThreads.empty() || ( _nItems < 2 ) )
+    {
+      for ( size_t stItem = 0; stItem < _nItems; ++stItem )
+        _rfn( stItem );
+      return;
+    }
+    _TyFunctionItem fnItem( std::ref( _rfn ) );
+    {
+      unique_lock< mutex > lock( m_mtx );
+      Assert( !m_nWorkersActive );
+      m_pfnItem = &fnItem;
+      m_nItems = _nItems;
+      m_stNextItem = 0;
+      m_excFirst = nullptr;
+      m_nWorkersActive = m_rgThreads.size();
+      ++m_nGeneration;
+    }
+    m_cvWork.notify_all();
+    _RunItems();
+    {
+      unique_lock< mutex > lock( m_mtx );
+      m_cvDone.wait( lock, [this]() { return !m_nWorkersActive; } );
+      m_pfnItem = nullptr;
+    }
+    if ( !!m_excFirst )
+    {
+      std::exception_ptr excFirst = m_excFirst;
+      m_excFirst = nullptr;
+      std::rethrow_exception( excFirst );
+    }
+  }
+
+protected:
+  void _RunItems()
+  {
+    for ( size_t stItem; ( stItem = m_stNextItem.fetch_add( 1 ) ) < m_nItems; )
+    {
+      try
+      {
+        (*m_pfnItem)( stItem );
+      }
+      catch( ... )
+      {
+        unique_lock< mutex > lock( m_mtx );
+        if ( !m_excFirst )
+          m_excFirst = std::current_exception();
+        m_stNextItem = m_nItems; // Don't start any further items.
+      }
+    }
+  }
+  void _WorkerThread()
+  {
+    size_t nGenerationSeen = 0;
+    for ( ; ; )
+    {
+      {
+        unique_lock< mutex > lock( m_mtx );
+        m_cvWork.wait( lock, [this,&nGenerationSeen]() { return m_fShutdown || ( nGenerationSeen != m_nGeneration ); } );
+        if ( m_fShutdown )
+          return;
+        nGenerationSeen = m_nGeneration;
+      }
+      _RunItems();
+      {
+        unique_lock< mutex > lock( m_mtx );
+        if ( !--m_nWorkersActive )
+          m_cvDone.notify_one();
+      }
+    }
+  }
+  void _Shutdown() noexcept
+  {
+    {
+      unique_lock< mutex > lock( m_mtx );
+      m_fShutdown = true;
+    }
+    m_cvWork.notify_all();
+    for ( std::thread & rthr : m_rgThreads )
+    {
+      if ( rthr.joinable() )
+        rthr.join();
+    }
+    m_rgThreads.clear();
+  }
+
+  vector< std::thread > m_rgThreads;
+  mutex m_mtx;
+  condition_variable m_cvWork;
+  condition_variable m_cvDone;
+  _TyFunctionItem * m_pfnItem{nullptr};
+  size_t m_nItems{0};
+  std::atomic< size_t > m_stNextItem{0};
+  size_t m_nWorkersActive{0};
+  size_t m_nGeneration{0};
+  std::exception_ptr m_excFirst;
+  bool m_fShutdown{false};
+};
+
+__REGEXP_END_NAMESPACE
@@ -29,6 +29,8 @@ public:
 };
 
 static const size_t vknchTransportFdTokenBufferSize = 256;
+// Initial buffer size used by _l_transport_file for regular files - it is clamped to the length of the file.
+static const size_t vknbyTransportFileBlockSize = 128 * 1024;
 static_assert( sizeof( vtySeekOffset ) == sizeof( vtyDataPosition ) );
 
 // _l_transport_backed_ctxt:
@@ -207,10 +209,14 @@ public:
   {
     m_frrFileDesBuffer.swap( _r.m_frrFileDesBuffer );
     m_file.swap( _r.m_file );
+    std::swap( m_nbyBlock, _r.m_nbyBlock );
     std::swap( m_fisatty, _r.m_fisatty );
   }
 
-  _l_transport_file( const char * _pszFileName )
+  // _nbyBlock: The initial size of the read buffer for regular files. Pipes and ttys always use vknchTransportFdTokenBufferSize.
+  //  In either case the buffer grows as needed to hold the current token.
+  _l_transport_file( const char * _pszFileName, size_t _nbyBlock = vknbyTransportFileBlockSize )
+    : m_nbyBlock( _nbyBlock )
   {
     PrepareErrNo();
     vtyFileHandle hFile = OpenReadOnlyFile( _pszFileName );
@@ -220,15 +226,17 @@ public:
     _InitNonTty();
   }
   // We must read starting at the current seek position of the file. This skips any BOM - or whatever the caller wants to skip, etc.
-  _l_transport_file( FileObj & _rfoFile )
+  _l_transport_file( FileObj & _rfoFile, size_t _nbyBlock = vknbyTransportFileBlockSize )
+    : m_nbyBlock( _nbyBlock )
   {
     VerifyThrowSz( _rfoFile.FIsOpen(), "Caller should pass an open file..." );
     m_file = std::move( _rfoFile );
     _InitNonTty();
   }
   // Attach to an hFile like STDIN - in which case you would set _fOwnFd to false.
-  _l_transport_file( vtyFileHandle _hFile, uint64_t _posEnd /*= 0*/, bool _fOwnFd = false )
-    : m_file( _hFile, _fOwnFd )
+  _l_transport_file( vtyFileHandle _hFile, uint64_t _posEnd /*= 0*/, bool _fOwnFd = false, size_t _nbyBlock = vknbyTransportFileBlockSize )
+    : m_file( _hFile, _fOwnFd ),
+      m_nbyBlock( _nbyBlock )
   {
     m_fisatty = FIsConsoleFileHandle( m_file.HFileGet() );
     m_fisatty ? _InitTty() : _InitNonTty( _posEnd );
@@ -390,18 +398,159 @@ protected:
       stchLenRead = posEnd - posInit;
       // Reset the seek to where we were at the beginning.
       (void)NFileSeekAndThrow( m_file.HFileGet(), nbySeekCur, vkSeekBegin );
+      _InitRegularFileBuffer( nbySeekCur, stchLenRead );
     }
     // The initial position is always 0 - regardless of where we actually started in the file.
     // We could do it otherwise which would allow easier debugging but... this is how we are doing it now.
     m_frrFileDesBuffer.Init( m_file.HFileGet(), 0, fReadAhead, stchLenRead );
   }
+  // Size the buffer for a regular file and tell the kernel we will read it sequentially. We read [_nbyStart,_nbyStart+_stchLen*sizeof(_TyChar)).
+  void _InitRegularFileBuffer( vtySeekOffset _nbyStart, uint64_t _stchLen )
+  {
+    uint64_t nbyLen = _stchLen * sizeof( _TyChar );
+    size_t nbyBuffer = (size_t)(std::min)( (uint64_t)m_nbyBlock, nbyLen );
+    nbyBuffer = (std::max)( nbyBuffer - nbyBuffer % sizeof( _TyChar ), vknchTransportFdTokenBufferSize * sizeof( _TyChar ) );
+    _TyFdReadRotating frrSized( nbyBuffer );
+    m_frrFileDesBuffer.swap( frrSized );
+#ifndef WIN32
+    // Advice only - failure is not an error.
+    (void)posix_fadvise( m_file.HFileGet(), (off_t)_nbyStart, (off_t)nbyLen, POSIX_FADV_SEQUENTIAL );
+    (void)posix_fadvise( m_file.HFileGet(), (off_t)_nbyStart, (off_t)(std::min)( nbyLen, 4 * (uint64_t)nbyBuffer ), POSIX_FADV_WILLNEED );
+#endif //!WIN32
+  }
   // We define a "rotating buffer" that will hold a single token *no matter how large* (since this is how the algorithm works to allow for STDIN filters to work).
   typedef FdReadRotating< _TyChar, s_kfSwitchEndian > _TyFdReadRotating;
   _TyFdReadRotating m_frrFileDesBuffer{ vknchTransportFdTokenBufferSize * sizeof( _TyChar ) };
   FileObj m_file;
+  size_t m_nbyBlock{vknbyTransportFileBlockSize};
   bool m_fisatty{false};
 };
 
+// _l_transport_chunk_ctxt:
+// Token context referencing the chunk of input that contains the token. The chunk is kept alive by the context - so tokens
+//  may outlive the transport. A transport over caller owned memory may give a chunk pointer without an owner.
+template < class t_TyChar >
+class _l_transport_chunk_ctxt
+{
+  typedef _l_transport_chunk_ctxt _TyThis;
+public:
+  typedef t_TyChar _TyChar;
+  typedef _l_fixed_buf< _TyChar > _TyBuffer;
+  typedef _l_data<> _TyData;
+  typedef shared_ptr< const void > _TyChunkPtr;
+
+  _l_transport_chunk_ctxt( vtyDataPosition _posTokenStart, _TyChunkPtr const & _rspChunk, _TyBuffer const & _bufTokenData )
+    : m_posTokenStart( _posTokenStart ),
+      m_spChunk( _rspChunk ),
+      m_bufTokenData( _bufTokenData )
+  {
+  }
+  ~_l_transport_chunk_ctxt() = default;
+  _l_transport_chunk_ctxt() = default;
+  _l_transport_chunk_ctxt( _l_transport_chunk_ctxt const & ) = default;
+  _l_transport_chunk_ctxt & operator =( _l_transport_chunk_ctxt const & ) = default;
+  _l_transport_chunk_ctxt( _l_transport_chunk_ctxt && _rr )
+    : m_spChunk( std::move( _rr.m_spChunk ) ),
+      m_bufTokenData( std::move( _rr.m_bufTokenData ) )
+  {
+    std::swap( m_posTokenStart, _rr.m_posTokenStart );
+  }
+  _l_transport_chunk_ctxt & operator =( _l_transport_chunk_ctxt && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+     std::swap( m_posTokenStart, _r.m_posTokenStart );
+     m_spChunk.swap( _r.m_spChunk );
+     m_bufTokenData.swap( _r.m_bufTokenData );
+  }
+  void AssertValid() const
+  {
+#if ASSERTSENABLED
+    Assert( ( m_posTokenStart == (numeric_limits< vtyDataPosition >::max)() ) == !m_spChunk );
+#endif //ASSERTSENABLED    
+  }
+  bool FIsNull() const
+  {
+    AssertValid();
+    return ( m_posTokenStart == (numeric_limits< vtyDataPosition >::max)() );
+  }
+  vtyDataPosition PosTokenStart() const
+  {
+    return m_posTokenStart;
+  }
+  size_t NLenToken() const
+  {
+    return m_bufTokenData.length();
+  }
+  void GetTokenDataRange( _l_data_range & _rdr ) const
+  {
+    _rdr.m_posBegin = m_posTokenStart;
+    _rdr.m_posEnd = m_posTokenStart + m_bufTokenData.length();
+  }
+  _TyBuffer const & GetTokenBuffer() const
+  {
+    return m_bufTokenData;
+  }
+  const _TyChar * PCBufferBegin() const
+  {
+    return GetTokenBuffer().begin();
+  }
+  template < class t_TyStrView >
+  void GetStringView(  t_TyStrView & _rsv, _l_data_range const & _rdr ) const
+    requires( sizeof( typename t_TyStrView::value_type ) == sizeof( _TyChar ) )
+  {
+    _AssertValidRange( _rdr.begin(), _rdr.end() );
+    GetTokenBuffer().GetStringView( _rsv, _rdr.begin() - PosTokenStart(), _rdr.end() - PosTokenStart() );
+  }
+  template < class t_TyStrView >
+  void GetStringView(  t_TyStrView & _rsv, _l_data_typed_range const & _rdtr ) const
+    requires( sizeof( typename t_TyStrView::value_type ) == sizeof( _TyChar ) )
+  {
+    return GetStringView( _rsv, _rdtr.GetRangeBase() );
+  }
+  void AssertValidDataRange( _TyData const & _rdt ) const
+  {
+#if ASSERTSENABLED
+    if ( !_rdt.FIsNull() )
+    {
+      if ( _rdt.FContainsSingleDataRange() )
+      {
+        _AssertValidRange( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end() );
+      }
+      else
+      {
+        _rdt.GetSegArrayDataRanges().ApplyContiguous( 0, _rdt.GetSegArrayDataRanges().NElements(), 
+          [this]( const _l_data_typed_range * _pdtrBegin, const _l_data_typed_range * _pdtrEnd )
+          {
+            for( ; _pdtrEnd != _pdtrBegin; ++_pdtrBegin )
+            {
+              if ( !_pdtrBegin->FIsNull() )
+                _AssertValidRange( _pdtrBegin->begin(), _pdtrBegin->end() );
+            }
+          }
+        );
+      }
+    }
+#endif //ASSERTSENABLED  
+  }
+protected:
+  void _AssertValidRange( vtyDataPosition _posBegin, vtyDataPosition _posEnd ) const
+  {
+#if ASSERTSENABLED
+    Assert( _posEnd >= _posBegin );
+    Assert( _posBegin >= m_posTokenStart );
+    Assert( ( vkdpNullDataPosition == _posEnd ) || ( _posEnd <= m_posTokenStart + m_bufTokenData.length() ) );
+#endif //ASSERTSENABLED  
+  }
+  vtyDataPosition m_posTokenStart{ (numeric_limits< vtyDataPosition >::max)() };
+  _TyChunkPtr m_spChunk; // The block containing the token or a copy of a token that spans blocks.
+  _TyBuffer m_bufTokenData;
+};
+
 template < class t_TyChar >
 class _l_transport_fixedmem_ctxt
 {
@@ -763,6 +912,29 @@ protected:
   {
     return m_bufCurrentToken.end() == m_bufFull.end();
   }
+  // FGetChar() for when a sentinel 0 follows the data - the bounds are only checked when a 0 is read.
+  bool _FGetCharSentinel( _TyChar & _rc )
+  {
+    const _TyChar * pcCur = m_bufCurrentToken.end();
+    if ( !*pcCur && ( m_bufFull.end() == pcCur ) )
+      return false;
+    ++m_bufCurrentToken.RLength();
+    if ( s_kfSwitchEndian )
+      SwitchEndian( _rc = *pcCur );
+    else
+      _rc = *pcCur;
+    return true;
+  }
+  // Return the current character and move past it unless it is 0 - for analyzers that take 0 as eof, for which the sentinel
+  //  and a 0 within the data both end the scan. There is no bounds check and no branch.
+  _TyChar _CGetCharSentinel()
+  {
+    _TyChar c = *m_bufCurrentToken.end();
+    if ( s_kfSwitchEndian )
+      SwitchEndian( c );
+    m_bufCurrentToken.RLength() += size_t( !!c );
+    return c;
+  }
   vtyDataPosition _PosTokenStart() const
   {
     return m_bufCurrentToken.begin() - m_bufFull.begin();
@@ -876,9 +1048,123 @@ public:
 protected:
   using _TyBase::m_bufFull; // The full view of the fixed memory that we are passing through the lexical analyzer.
   using _TyBase::m_bufCurrentToken; // The view for the current token's exploration.
+  using _TyBase::_FGetCharSentinel;
+  using _TyBase::_CGetCharSentinel;
   FileMappingObj m_fmoMappedFile;
 };
 
+// _l_transport_fixedmem_sentinel:
+// Fixed memory transport for which the caller guarantees a 0 character immediately after the data. FGetChar() only checks
+//  the bounds when it reads a 0 - 0 characters within the data are still returned. An analyzer that takes 0 as eof reads
+//  with CGetCharSentinel() instead ( see _l_analyzer<>::_NextChar() ) and so has no bounds check or test at all.
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_fixedmem_sentinel : public _l_transport_fixedmem< t_TyChar, t_TyBoolSwitchEndian >
+{
+  typedef _l_transport_fixedmem_sentinel _TyThis;
+  typedef _l_transport_fixedmem< t_TyChar, t_TyBoolSwitchEndian > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+
+  _l_transport_fixedmem_sentinel() = default;
+  // _pcBase[ _nLenChars ] must be readable and 0.
+  _l_transport_fixedmem_sentinel( const _TyChar * _pcBase, size_t _nLenChars )
+    : _TyBase( _pcBase, _nLenChars )
+  {
+    VerifyThrowSz( !_pcBase[ _nLenChars ], "The data must be followed by a 0 character." );
+  }
+  bool FGetChar( _TyChar & _rc )
+  {
+    return _TyBase::_FGetCharSentinel( _rc );
+  }
+  _TyChar CGetCharSentinel()
+  {
+    return _TyBase::_CGetCharSentinel();
+  }
+};
+
+// _l_transport_mapped_sentinel:
+// Mapped transport with a 0 character after the data - see _l_transport_fixedmem_sentinel. The zero fill at the end of the
+//  last page of the mapping is the sentinel. When the data ends exactly at a page boundary there is no such fill and the data
+//  is copied into a buffer that has the sentinel - this is the only case that costs more than the plain mapped transport.
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_mapped_sentinel : public _l_transport_mapped< t_TyChar, t_TyBoolSwitchEndian >
+{
+  typedef _l_transport_mapped_sentinel _TyThis;
+  typedef _l_transport_mapped< t_TyChar, t_TyBoolSwitchEndian > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+
+  _l_transport_mapped_sentinel() = default;
+  _l_transport_mapped_sentinel( _l_transport_mapped_sentinel && _rr ) = default;
+  _l_transport_mapped_sentinel& operator =( _l_transport_mapped_sentinel && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+    _TyBase::swap( _r );
+    m_upcCopy.swap( _r.m_upcCopy );
+  }
+  _l_transport_mapped_sentinel( const char * _pszFileName )
+    : _TyBase( _pszFileName )
+  {
+    _EnsureSentinel();
+  }
+  _l_transport_mapped_sentinel( FileObj & _rfoFile )
+    : _TyBase( _rfoFile )
+  {
+    _EnsureSentinel();
+  }
+  bool FGetChar( _TyChar & _rc )
+  {
+    return _FGetCharSentinel( _rc );
+  }
+  _TyChar CGetCharSentinel()
+  {
+    return _CGetCharSentinel();
+  }
+protected:
+  void _EnsureSentinel()
+  {
+    // The base rejects a partial trailing character. The zero fill serves only if a whole aligned character fits after the data
+    //  within the last page - a mapping at an odd seek position of a wide file may leave a single byte.
+    const size_t knbyPageOffset = size_t( uintptr_t( m_bufFull.end() ) & ( _NbyPageSize() - 1 ) );
+    if ( !!m_bufFull.length() && !!knbyPageOffset && ( _NbyPageSize() - knbyPageOffset >= sizeof( _TyChar ) ) &&
+         !( uintptr_t( m_bufFull.end() ) % alignof( _TyChar ) ) )
+    {
+      Assert( !*m_bufFull.end() ); // The zero fill of the last page.
+      return;
+    }
+    size_t nLenChars = m_bufFull.length();
+    m_upcCopy = make_unique< _TyChar[] >( nLenChars + 1 ); // value initialized - so the sentinel is 0.
+    if ( nLenChars )
+      memcpy( m_upcCopy.get(), m_bufFull.begin(), nLenChars * sizeof( _TyChar ) );
+    m_bufFull.RCharP() = m_upcCopy.get();
+    m_bufCurrentToken.RCharP() = m_bufFull.begin();
+    FileMappingObj fmoNone;
+    m_fmoMappedFile.swap( fmoNone ); // Don't need the mapping anymore.
+  }
+  static size_t _NbyPageSize()
+  {
+#ifdef WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo( &si );
+    return si.dwPageSize;
+#else //!WIN32
+    static const size_t s_knbyPage = (size_t)sysconf( _SC_PAGESIZE );
+    return s_knbyPage;
+#endif //!WIN32
+  }
+  using _TyBase::m_bufFull;
+  using _TyBase::m_bufCurrentToken;
+  using _TyBase::m_fmoMappedFile;
+  using _TyBase::_FGetCharSentinel;
+  using _TyBase::_CGetCharSentinel;
+  unique_ptr< _TyChar[] > m_upcCopy; // Only when the mapping has no room for the sentinel.
+};
+
 // Produce a variant that is the set of all potential transports that the user of the object may care to use.
 // We provide no functionality in this class
 template < class t_TyVariant >
@@ -1038,6 +1324,25 @@ public:
   {
     m_var.template emplace< t_TyTransport >( std::forward< t_TysArgs >( _args ) ... );
   }
+  // Call _rrftor with the active transport. The analyzer uses this to dispatch once per call to FGetToken() or FGetTokens()
+  //  and then scan using code instantiated for the concrete transport. _rrftor must return the same type for each transport.
+  template < class t_TyFunctor >
+  decltype(auto) VisitTransport( t_TyFunctor && _rrftor )
+  {
+    typedef invoke_result_t< t_TyFunctor, typename tuple_element< 0, tuple< t_TysTransports... > >::type & > _TyResult;
+    return std::visit(_VisitHelpOverloadFCall {
+      [](monostate) -> _TyResult
+      {
+        THROWNAMEDBADVARIANTACCESSEXCEPTION("Transport object hasn't been created.");
+        if constexpr ( !is_void_v< _TyResult > )
+          return _TyResult();
+      },
+      [&_rrftor]( auto & _transport ) -> _TyResult
+      {
+        return _rrftor( _transport );
+      }
+    }, m_var );
+  }
   void AssertValid() const
   {
 #if ASSERTSENABLED
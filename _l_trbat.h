@@ -0,0 +1,233 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_trbat.h
+// Multi-document batch transport for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// _l_transport_batch lexes many small documents packed into one buffer - e.g. log records or messages - without creating a
+//  transport per document. The caller passes the buffer and the position at which each document starts, a document ends
+//  where the next one starts. The end of a document looks like eof to the analyzer so no token spans documents, and the
+//  analyzer moves to the next document by calling FNextDocument() ( see _l_analyzer<>::_FNextDocument() ) and starts over
+//  in the start state. A document in which no token is found is skipped by the analyzer when it isn't throwing - otherwise
+//  the caller may skip it with FNextDocument() after catching. Each token's context records the index of its document - see _l_transport_document_ctxt.
+// Positions are those within the whole buffer - subtract PosDocumentBegin() for the position within the document. As with
+//  _l_transport_fixedmem the buffer and the document positions belong to the caller and must outlive the transport and
+//  the tokens.
+
+#include "_l_transport.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+// _l_transport_document_ctxt:
+// A transport context that also records the index of the document containing the token.
+template < class t_TyTransportCtxt >
+class _l_transport_document_ctxt : public t_TyTransportCtxt
+{
+  typedef _l_transport_document_ctxt _TyThis;
+  typedef t_TyTransportCtxt _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+  using typename _TyBase::_TyBuffer;
+  using typename _TyBase::_TyData;
+
+  template < class ... t_TysArgs >
+  _l_transport_document_ctxt( size_t _iDocument, t_TysArgs && ... _args )
+    : _TyBase( std::forward< t_TysArgs >( _args ) ... ),
+      m_iDocument( _iDocument )
+  {
+  }
+  _l_transport_document_ctxt() = default;
+  _l_transport_document_ctxt( _l_transport_document_ctxt const & ) = default;
+  _l_transport_document_ctxt & operator =( _l_transport_document_ctxt const & ) = default;
+  _l_transport_document_ctxt( _l_transport_document_ctxt && _rr )
+    : _TyBase( std::move( static_cast< _TyBase && >( _rr ) ) ),
+      m_iDocument( _rr.m_iDocument )
+  {
+  }
+  _l_transport_document_ctxt & operator =( _l_transport_document_ctxt && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+    _TyBase::swap( _r );
+    std::swap( m_iDocument, _r.m_iDocument );
+  }
+  size_t IDocument() const
+  {
+    return m_iDocument;
+  }
+protected:
+  size_t m_iDocument{0};
+};
+
+// _l_transport_batch:
+// Transport over documents packed into a single buffer.
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_batch : protected _l_transport_fixedmem< t_TyChar, t_TyBoolSwitchEndian >
+{
+  typedef _l_transport_batch _TyThis;
+  typedef _l_transport_fixedmem< t_TyChar, t_TyBoolSwitchEndian > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+  using typename _TyBase::_TyBoolSwitchEndian;
+  using typename _TyBase::_TyData;
+  using typename _TyBase::_TyAxnObjBase;
+  using _TyBase::s_kfSwitchEndian;
+  using _TyTransportCtxt = _l_transport_document_ctxt< typename _TyBase::_TyTransportCtxt >;
+
+  _l_transport_batch() = default;
+  _l_transport_batch( _l_transport_batch const & _r ) = default;
+  _TyThis & operator = ( _TyThis const & _r ) = default;
+  // _rgposDocuments[ i ] is the position of the first character of document i within [_pcBase,_pcBase+_nLenChars). The
+  //  positions must not decrease - the last document ends at _nLenChars.
+  _l_transport_batch( const _TyChar * _pcBase, size_t _nLenChars, const size_t * _rgposDocuments, size_t _nDocuments )
+    : _TyBase( _pcBase, _nLenChars ),
+      m_rgposDocuments( _rgposDocuments ),
+      m_nDocuments( _nDocuments )
+  {
+    for ( size_t iDocument = 0; iDocument < _nDocuments; ++iDocument )
+    {
+      VerifyThrowSz( ( _rgposDocuments[ iDocument ] <= _nLenChars ) && ( !iDocument || ( _rgposDocuments[ iDocument - 1 ] <= _rgposDocuments[ iDocument ] ) ),
+        "Document[%zu] starts at [%zu] which is out of order or beyond the buffer length[%zu].", iDocument, _rgposDocuments[ iDocument ], _nLenChars );
+    }
+    _SetDocument( 0 );
+  }
+  void swap( _TyThis & _r )
+  {
+    _TyBase::swap( _r );
+    std::swap( m_rgposDocuments, _r.m_rgposDocuments );
+    std::swap( m_nDocuments, _r.m_nDocuments );
+    std::swap( m_iDocument, _r.m_iDocument );
+    std::swap( m_pcDocumentEnd, _r.m_pcDocumentEnd );
+  }
+  void AssertValid() const
+  {
+#if ASSERTSENABLED
+    _TyBase::AssertValid();
+    Assert( !m_nDocuments || ( m_iDocument < m_nDocuments ) );
+    Assert( m_bufCurrentToken.end() <= m_pcDocumentEnd );
+    Assert( m_pcDocumentEnd <= m_bufFull.end() );
+#endif //ASSERTSENABLED
+  }
+  static EFileCharacterEncoding GetSupportedCharacterEncoding()
+  {
+    return GetCharacterEncoding< _TyChar, _TyBoolSwitchEndian >();
+  }
+  bool FDependentTransportContexts() const
+  {
+    return false;
+  }
+  size_t NDocuments() const
+  {
+    return m_nDocuments;
+  }
+  // The index of the document being lexed.
+  size_t IDocument() const
+  {
+    return m_iDocument;
+  }
+  vtyDataPosition PosDocumentBegin( size_t _iDocument ) const
+  {
+    Assert( _iDocument < m_nDocuments );
+    return m_rgposDocuments[ _iDocument ];
+  }
+  // Discard the rest of the current document - including any partial token - and move to the start of the next. Return false
+  //  if this is the last document, which is then left as it is - GetCurTokenString() still returns the partial token. Call this
+  //  to skip a document in which no token was found.
+  bool FNextDocument()
+  {
+    if ( m_iDocument + 1 >= m_nDocuments )
+      return false;
+    _SetDocument( m_iDocument + 1 );
+    return true;
+  }
+
+  using _TyBase::PosCurrent;
+  using _TyBase::PosTokenStart;
+  using _TyBase::FAtTokenStart;
+  using _TyBase::ResetToTokenStart;
+  // Return the current character and advance the position - the end of the document is the end of the input.
+  bool FGetChar( _TyChar & _rc )
+  {
+    if ( m_bufCurrentToken.end() == m_pcDocumentEnd )
+      return false;
+    if ( s_kfSwitchEndian )
+      SwitchEndian( _rc = m_bufCurrentToken.begin()[ m_bufCurrentToken.RLength()++ ] );
+    else
+      _rc = m_bufCurrentToken.begin()[ m_bufCurrentToken.RLength()++ ];
+    return true;
+  }
+  // As _l_transport_fixedmem::GetPToken() but the context also records the document.
+  template < class t_TyToken, class t_TyValue, class t_TyUserObj >
+  void GetPToken( const _TyAxnObjBase* _paobCurToken, const vtyDataPosition _kdpEndToken,
+                  t_TyValue & _rvalue, t_TyUserObj& _ruoUserObj, unique_ptr< t_TyToken >& _rupToken)
+  {
+    typedef typename t_TyToken::_TyValue _TyValue;
+    static_assert( is_same_v< t_TyValue, _TyValue > );
+    typedef typename t_TyToken::_TyUserContext _TyUserContext;
+    typedef typename _TyUserContext::_TyUserObj _TyUserObj;
+    static_assert( is_same_v< t_TyUserObj, _TyUserObj > );
+    Assert( _kdpEndToken >= _PosTokenStart() );
+    Assert( _kdpEndToken <= _PosTokenEnd() );
+    size_t nLenToken = size_t( _kdpEndToken - _PosTokenStart() );
+    typedef typename _TyTransportCtxt::_TyBuffer _TyBuffer;
+    _TyUserContext ucxt( _ruoUserObj, m_iDocument, _PosTokenStart(), _TyBuffer( m_bufCurrentToken.begin(), nLenToken ) );
+    if ( s_kfSwitchEndian )
+      SwitchEndian( ucxt.GetTokenBuffer().begin(), ucxt.GetTokenBuffer().end() );
+    m_bufCurrentToken.RCharP() += nLenToken;
+    m_bufCurrentToken.RLength() = 0;
+    unique_ptr< t_TyToken > upToken = make_unique< t_TyToken >( std::move( ucxt ), std::move( _rvalue ), _paobCurToken );
+    upToken.swap( _rupToken );
+  }
+  _TyTransportCtxt CtxtEatCurrentToken( const vtyDataPosition _kdpEndToken )
+  {
+    Assert( _kdpEndToken >= _PosTokenStart() );
+    Assert( _kdpEndToken <= _PosTokenEnd() );
+    size_t nLenToken = size_t( _kdpEndToken - _PosTokenStart() );
+    typedef typename _TyTransportCtxt::_TyBuffer _TyBuffer;
+    _TyBuffer bufToken( m_bufCurrentToken.begin(), nLenToken );
+    if ( s_kfSwitchEndian )
+      SwitchEndian( bufToken.begin(), bufToken.end() );
+    vtyDataPosition posTokenStart = _PosTokenStart();
+    m_bufCurrentToken.RCharP() += nLenToken;
+    m_bufCurrentToken.RLength() = 0;
+    return _TyTransportCtxt( m_iDocument, posTokenStart, std::move( bufToken ) );
+  }
+  using _TyBase::DiscardData;
+  using _TyBase::GetCurTokenString;
+  using _TyBase::FSpanChars;
+  using _TyBase::FMatchChars;
+  using _TyBase::AssertValidDataRange;
+protected:
+  void _SetDocument( size_t _iDocument )
+  {
+    m_iDocument = _iDocument;
+    if ( _iDocument < m_nDocuments )
+    {
+      m_bufCurrentToken.RCharP() = m_bufFull.begin() + m_rgposDocuments[ _iDocument ];
+      m_pcDocumentEnd = ( _iDocument + 1 < m_nDocuments ) ? ( m_bufFull.begin() + m_rgposDocuments[ _iDocument + 1 ] ) : m_bufFull.end();
+    }
+    else
+      m_pcDocumentEnd = m_bufCurrentToken.begin(); // No documents.
+    m_bufCurrentToken.RLength() = 0;
+  }
+  using _TyBase::_PosTokenStart;
+  using _TyBase::_PosTokenEnd;
+  using _TyBase::m_bufFull;
+  using _TyBase::m_bufCurrentToken;
+  const size_t * m_rgposDocuments{nullptr};
+  size_t m_nDocuments{0};
+  size_t m_iDocument{0};
+  const _TyChar * m_pcDocumentEnd{nullptr};
+};
+
+__LEXOBJ_END_NAMESPACE
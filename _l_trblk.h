@@ -0,0 +1,788 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_trblk.h
+// Block reading transports for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// _l_transport_block reads its input as a chain of fixed size blocks obtained from a read source. Blocks are requested from
+//  the source ahead of the analyzer so that a source that reads asynchronously overlaps I/O with lexing. A block is released
+//  back to the source once the token start has passed it - so memory is bounded by the read ahead plus the longest token.
+// A read source provides:
+//  bool FSubmitRead( _l_input_block & _rib ) : Start filling _rib with the next bytes of input. Return false at the end of input.
+//  void WaitRead( _l_input_block & _rib ) : Wait for a submitted read to complete and set _rib.m_nbyValid.
+//  void DrainReads() : Wait for every read that may still be writing to a block - before blocks are freed or the file is closed.
+// Sources must fill each block completely except at the end of the input.
+// Positions have the same semantics as _l_transport_file: position 0 is the first character read.
+// Blocks are refcounted and tokens are returned in a _l_transport_chunk_ctxt which references the block containing the
+//  token - no copy is made unless the token spans blocks. A block that is still referenced by a token when the analyzer
+//  is done with it isn't reused. When switching endian tokens are copied into a _l_transport_backed_ctxt.
+// _l_transport_readahead uses positioned reads and so is only for regular files, _l_transport_file_chunked reads any file
+//  descriptor sequentially.
+
+#ifndef WIN32
+
+#include <deque>
+#include <unistd.h>
+#ifdef LXOBJ_IO_URING
+#include <liburing.h>
+#endif //LXOBJ_IO_URING
+#include "_l_transport.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+static const size_t vknbyTransportBlockSize = 256 * 1024;
+static const size_t vknTransportBlocksAhead = 2;
+
+// _l_input_block: A block of input.
+struct _l_input_block
+{
+  unique_ptr< uint8_t[] > m_rgby;
+  size_t m_nbyCapacity{0};
+  size_t m_nbyRequest{0}; // The number of bytes the current read asked for.
+  size_t m_nbyValid{0}; // The number of bytes read.
+  uint64_t m_nbyOffset{0}; // The offset in the source of the first byte.
+  vtyDataPosition m_posBegin{0}; // The position of the first character - set when the block is consumed.
+  bool m_fPending{false}; // A read has been submitted and not yet waited for.
+
+  explicit _l_input_block( size_t _nbyCapacity )
+    : m_rgby( make_unique< uint8_t[] >( _nbyCapacity ) ),
+      m_nbyCapacity( _nbyCapacity )
+  {
+  }
+};
+
+// _l_read_source_fd: Read a range of a regular file with pread() when the block is waited for.
+class _l_read_source_fd
+{
+  typedef _l_read_source_fd _TyThis;
+public:
+  _l_read_source_fd() = default;
+  _l_read_source_fd( _l_read_source_fd const & ) = delete;
+  _l_read_source_fd & operator =( _l_read_source_fd const & ) = delete;
+  _l_read_source_fd( _l_read_source_fd && ) = default;
+  _l_read_source_fd & operator =( _l_read_source_fd && ) = default;
+
+  // Read [_nbyBegin,_nbyEnd) of _hFile.
+  void Init( vtyFileHandle _hFile, uint64_t _nbyBegin, uint64_t _nbyEnd )
+  {
+    m_hFile = _hFile;
+    m_nbyNext = _nbyBegin;
+    m_nbyEnd = _nbyEnd;
+  }
+  bool FSubmitRead( _l_input_block & _rib )
+  {
+    Assert( !_rib.m_fPending );
+    if ( m_nbyNext >= m_nbyEnd )
+      return false;
+    _rib.m_nbyOffset = m_nbyNext;
+    _rib.m_nbyRequest = (size_t)(std::min)( (uint64_t)_rib.m_nbyCapacity, m_nbyEnd - m_nbyNext );
+    _rib.m_nbyValid = 0;
+    _rib.m_fPending = true;
+    m_nbyNext += _rib.m_nbyRequest;
+    return true;
+  }
+  // Reads happen in WaitRead() - nothing is in flight.
+  void DrainReads()
+  {
+  }
+  void WaitRead( _l_input_block & _rib )
+  {
+    Assert( _rib.m_fPending );
+    _rib.m_nbyValid = NReadAt( m_hFile, _rib.m_rgby.get(), _rib.m_nbyRequest, _rib.m_nbyOffset );
+    _rib.m_fPending = false;
+  }
+  // Read until _nby bytes are read or eof. Returns the number of bytes read.
+  static size_t NReadAt( vtyFileHandle _hFile, uint8_t * _pby, size_t _nby, uint64_t _nbyOffset )
+  {
+    size_t nbyRead = 0;
+    while ( nbyRead < _nby )
+    {
+      PrepareErrNo();
+      ssize_t nbyCur = ::pread( _hFile, _pby + nbyRead, _nby - nbyRead, (off_t)( _nbyOffset + nbyRead ) );
+      if ( nbyCur < 0 )
+      {
+        if ( EINTR == errno )
+          continue;
+        THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "pread() of hFile[0x%zx] failed.", (size_t)_hFile );
+      }
+      if ( !nbyCur )
+        break; // The file has been truncated.
+      nbyRead += nbyCur;
+    }
+    return nbyRead;
+  }
+protected:
+  vtyFileHandle m_hFile{vkhInvalidFileHandle};
+  uint64_t m_nbyNext{0};
+  uint64_t m_nbyEnd{0};
+};
+
+// _l_read_source_stream: Read a file descriptor sequentially with read() - for pipes as well as files. The read for a block
+//  happens when it is waited for, blocks are waited for in the order they were submitted.
+class _l_read_source_stream
+{
+  typedef _l_read_source_stream _TyThis;
+public:
+  _l_read_source_stream() = default;
+  _l_read_source_stream( _l_read_source_stream const & ) = delete;
+  _l_read_source_stream & operator =( _l_read_source_stream const & ) = delete;
+  _l_read_source_stream( _l_read_source_stream && ) = default;
+  _l_read_source_stream & operator =( _l_read_source_stream && ) = default;
+
+  void Init( vtyFileHandle _hFile )
+  {
+    m_hFile = _hFile;
+    m_nbyRead = 0;
+    m_fEof = false;
+  }
+  bool FSubmitRead( _l_input_block & _rib )
+  {
+    Assert( !_rib.m_fPending );
+    if ( m_fEof )
+      return false;
+    _rib.m_nbyRequest = _rib.m_nbyCapacity;
+    _rib.m_nbyValid = 0;
+    _rib.m_fPending = true;
+    return true;
+  }
+  // Reads happen in WaitRead() - nothing is in flight.
+  void DrainReads()
+  {
+  }
+  void WaitRead( _l_input_block & _rib )
+  {
+    Assert( _rib.m_fPending );
+    _rib.m_nbyOffset = m_nbyRead;
+    _rib.m_nbyValid = m_fEof ? 0 : NRead( m_hFile, _rib.m_rgby.get(), _rib.m_nbyRequest );
+    m_fEof = _rib.m_nbyValid < _rib.m_nbyRequest;
+    m_nbyRead += _rib.m_nbyValid;
+    _rib.m_fPending = false;
+  }
+  // Read until _nby bytes are read or eof. Returns the number of bytes read.
+  static size_t NRead( vtyFileHandle _hFile, uint8_t * _pby, size_t _nby )
+  {
+    size_t nbyRead = 0;
+    while ( nbyRead < _nby )
+    {
+      PrepareErrNo();
+      ssize_t nbyCur = ::read( _hFile, _pby + nbyRead, _nby - nbyRead );
+      if ( nbyCur < 0 )
+      {
+        if ( EINTR == errno )
+          continue;
+        THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "read() of hFile[0x%zx] failed.", (size_t)_hFile );
+      }
+      if ( !nbyCur )
+        break;
+      nbyRead += nbyCur;
+    }
+    return nbyRead;
+  }
+protected:
+  vtyFileHandle m_hFile{vkhInvalidFileHandle};
+  uint64_t m_nbyRead{0};
+  bool m_fEof{false};
+};
+
+#ifdef LXOBJ_IO_URING
+// _l_read_source_uring: Read a range of a regular file with io_uring - the reads for the blocks ahead of the analyzer are in
+//  flight while it works. If io_uring isn't available at runtime then this reads like _l_read_source_fd.
+class _l_read_source_uring : public _l_read_source_fd
+{
+  typedef _l_read_source_uring _TyThis;
+  typedef _l_read_source_fd _TyBase;
+public:
+  _l_read_source_uring() = default;
+  _l_read_source_uring( _l_read_source_uring const & ) = delete;
+  _l_read_source_uring & operator =( _l_read_source_uring const & ) = delete;
+  _l_read_source_uring( _l_read_source_uring && _rr )
+    : _TyBase( std::move( _rr ) ),
+      m_upRing( std::move( _rr.m_upRing ) ),
+      m_nPending( std::exchange( _rr.m_nPending, 0 ) )
+  {
+  }
+  _l_read_source_uring & operator =( _l_read_source_uring && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+    std::swap( static_cast< _TyBase & >( *this ), static_cast< _TyBase & >( _r ) );
+    m_upRing.swap( _r.m_upRing );
+    std::swap( m_nPending, _r.m_nPending );
+  }
+  ~_l_read_source_uring()
+  {
+    if ( !!m_upRing )
+    {
+      DrainReads();
+      io_uring_queue_exit( m_upRing.get() );
+    }
+  }
+  // The blocks may not be freed nor the file closed while the kernel is reading into them. The completed blocks are left
+  //  pending - this is only for tearing down.
+  void DrainReads()
+  {
+    while ( !!m_upRing && m_nPending )
+    {
+      io_uring_cqe * pcqe;
+      int iResult = io_uring_wait_cqe( m_upRing.get(), &pcqe );
+      if ( -EINTR == iResult )
+        continue;
+      if ( iResult < 0 )
+        break;
+      io_uring_cqe_seen( m_upRing.get(), pcqe );
+      --m_nPending;
+    }
+  }
+  void Init( vtyFileHandle _hFile, uint64_t _nbyBegin, uint64_t _nbyEnd, unsigned _nEntries )
+  {
+    _TyBase::Init( _hFile, _nbyBegin, _nbyEnd );
+    unique_ptr< io_uring > upRing = make_unique< io_uring >();
+    if ( io_uring_queue_init( _nEntries, upRing.get(), 0 ) < 0 )
+      return; // Fall back to pread().
+    m_upRing.swap( upRing );
+  }
+  bool FSubmitRead( _l_input_block & _rib )
+  {
+    if ( !_TyBase::FSubmitRead( _rib ) )
+      return false;
+    if ( !m_upRing )
+      return true;
+    io_uring_sqe * psqe = io_uring_get_sqe( m_upRing.get() );
+    if ( !psqe )
+    {
+      (void)io_uring_submit( m_upRing.get() );
+      psqe = io_uring_get_sqe( m_upRing.get() );
+      VerifyThrowSz( !!psqe, "io_uring submission queue is full." );
+    }
+    io_uring_prep_read( psqe, m_hFile, _rib.m_rgby.get(), (unsigned)_rib.m_nbyRequest, _rib.m_nbyOffset );
+    io_uring_sqe_set_data( psqe, &_rib );
+    int iResult = io_uring_submit( m_upRing.get() );
+    if ( iResult < 0 )
+      THROWNAMEDEXCEPTIONERRNO( -iResult, "io_uring_submit() failed." );
+    ++m_nPending;
+    return true;
+  }
+  void WaitRead( _l_input_block & _rib )
+  {
+    if ( !m_upRing )
+      return _TyBase::WaitRead( _rib );
+    // Completions can arrive in any order - complete each block as it arrives until we see ours:
+    while ( _rib.m_fPending )
+    {
+      io_uring_cqe * pcqe;
+      int iResult = io_uring_wait_cqe( m_upRing.get(), &pcqe );
+      if ( -EINTR == iResult )
+        continue;
+      if ( iResult < 0 )
+        THROWNAMEDEXCEPTIONERRNO( -iResult, "io_uring_wait_cqe() failed." );
+      _l_input_block & ribDone = *(_l_input_block *)io_uring_cqe_get_data( pcqe );
+      int iRead = pcqe->res;
+      io_uring_cqe_seen( m_upRing.get(), pcqe );
+      --m_nPending;
+      if ( iRead < 0 )
+        THROWNAMEDEXCEPTIONERRNO( -iRead, "io_uring read of hFile[0x%zx] failed.", (size_t)m_hFile );
+      ribDone.m_nbyValid = iRead;
+      if ( ( ribDone.m_nbyValid < ribDone.m_nbyRequest ) && !!iRead ) // A short read - finish synchronously.
+        ribDone.m_nbyValid += NReadAt( m_hFile, ribDone.m_rgby.get() + iRead, ribDone.m_nbyRequest - iRead, ribDone.m_nbyOffset + iRead );
+      ribDone.m_fPending = false;
+    }
+  }
+protected:
+  unique_ptr< io_uring > m_upRing;
+  size_t m_nPending{0};
+};
+#endif //LXOBJ_IO_URING
+
+// _l_transport_block:
+// Transport reading a chain of blocks from a read source.
+template < class t_TyChar, class t_TySource, class t_TyBoolSwitchEndian >
+class _l_transport_block : public _l_transport_base< t_TyChar >
+{
+  typedef _l_transport_block _TyThis;
+  typedef _l_transport_base< t_TyChar > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+  typedef t_TySource _TySource;
+  typedef t_TyBoolSwitchEndian _TyBoolSwitchEndian;
+  using typename _TyBase::_TyData;
+  static constexpr bool s_kfSwitchEndian = _TyBoolSwitchEndian::value;
+  // The blocks are in the file's byte order so we must copy to switch endian.
+  using _TyTransportCtxt = typename std::conditional< s_kfSwitchEndian, _l_transport_backed_ctxt< _TyChar >, _l_transport_chunk_ctxt< _TyChar > >::type;
+  typedef _l_action_object_base< _TyChar, false > _TyAxnObjBase;
+
+  ~_l_transport_block()
+  {
+    m_source.DrainReads(); // Before the blocks are freed.
+  }
+  _l_transport_block() = delete;
+  _l_transport_block( const _l_transport_block & ) = delete;
+  _l_transport_block & operator =( _l_transport_block const & ) = delete;
+  _l_transport_block( _l_transport_block && ) = default;
+  // Our old blocks go away with acquire - whose destructor waits for their reads first.
+  _l_transport_block & operator =( _l_transport_block && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+    m_dqpibBlocks.swap( _r.m_dqpibBlocks );
+    m_rgpibFree.swap( _r.m_rgpibFree );
+    std::swap( m_source, _r.m_source );
+    std::swap( m_iBlockCur, _r.m_iBlockCur );
+    std::swap( m_pcCur, _r.m_pcCur );
+    std::swap( m_pcEnd, _r.m_pcEnd );
+    std::swap( m_posTokenStart, _r.m_posTokenStart );
+    std::swap( m_nbyBlock, _r.m_nbyBlock );
+    std::swap( m_nBlocksAhead, _r.m_nBlocksAhead );
+  }
+
+  static EFileCharacterEncoding GetSupportedCharacterEncoding()
+  {
+    return GetCharacterEncoding< _TyChar, _TyBoolSwitchEndian >();
+  }
+  bool FDependentTransportContexts() const
+  {
+    return false;
+  }
+  void AssertValid() const
+  {
+#if ASSERTSENABLED
+    Assert( !m_dqpibBlocks.empty() );
+    Assert( m_iBlockCur < m_dqpibBlocks.size() );
+    Assert( m_posTokenStart >= m_dqpibBlocks.front()->m_posBegin );
+    Assert( m_posTokenStart <= PosCurrent() );
+#endif //ASSERTSENABLED
+  }
+  vtyDataPosition PosTokenStart() const
+  {
+    return m_posTokenStart;
+  }
+  vtyDataPosition PosCurrent() const
+  {
+    return m_dqpibBlocks[ m_iBlockCur ]->m_posBegin + ( m_pcCur - _PcBlockBegin( *m_dqpibBlocks[ m_iBlockCur ] ) );
+  }
+  bool FAtTokenStart() const
+  {
+    return PosCurrent() == m_posTokenStart;
+  }
+  void ResetToTokenStart()
+  {
+    _SetPosCurrent( m_posTokenStart );
+  }
+  // Return the current character and advance the position.
+  bool FGetChar( _TyChar & _rc )
+  {
+    if ( ( m_pcCur == m_pcEnd ) && !_FNextBlock() )
+      return false;
+    _rc = *m_pcCur++;
+    if ( s_kfSwitchEndian )
+      SwitchEndian( _rc );
+    return true;
+  }
+  template < class t_TyToken, class t_TyValue, class t_TyUserObj >
+  void GetPToken( const _TyAxnObjBase * _paobCurToken, const vtyDataPosition _kdpEndToken,
+                  t_TyValue & _rvalue, t_TyUserObj & _ruoUserObj,
+                  unique_ptr< t_TyToken > & _rupToken )
+  {
+    typedef typename t_TyToken::_TyValue _TyValue;
+    static_assert( is_same_v< t_TyValue, _TyValue > );
+    typedef typename t_TyToken::_TyUserContext _TyUserContext;
+    typedef typename _TyUserContext::_TyUserObj _TyUserObj;
+    static_assert( is_same_v< t_TyUserObj, _TyUserObj > );
+    _TyUserContext ucxt( _ruoUserObj, CtxtEatCurrentToken( _kdpEndToken ) );
+    unique_ptr< t_TyToken > upToken = make_unique< t_TyToken >( std::move( ucxt ), std::move( _rvalue ), _paobCurToken );
+    upToken.swap( _rupToken );
+  }
+  _TyTransportCtxt CtxtEatCurrentToken( const vtyDataPosition _kdpEndToken )
+  {
+    Assert( _kdpEndToken >= m_posTokenStart );
+    Assert( _kdpEndToken <= PosCurrent() );
+    typedef typename _TyTransportCtxt::_TyBuffer _TyBuffer;
+    const size_t knchToken = size_t( _kdpEndToken - m_posTokenStart );
+    if constexpr ( s_kfSwitchEndian )
+    {
+      _TyTransportCtxt tcxt( m_posTokenStart, _TyBuffer( knchToken ) );
+      _CopyRange( m_posTokenStart, _kdpEndToken, tcxt.GetTokenBuffer().begin() );
+      DiscardData( _kdpEndToken );
+      return tcxt;
+    }
+    else
+    {
+      size_t iBlock = _IBlockContaining( m_posTokenStart );
+      shared_ptr< _l_input_block > const & rspib = m_dqpibBlocks[ iBlock ];
+      if ( _kdpEndToken <= rspib->m_posBegin + _NCharsBlock( *rspib ) )
+      {
+        // Zero-copy - reference the block:
+        const _TyChar * pcToken = _PcBlockBegin( *rspib ) + size_t( m_posTokenStart - rspib->m_posBegin );
+        _TyTransportCtxt tcxt( m_posTokenStart, rspib, knchToken ? _TyBuffer( pcToken, knchToken ) : _TyBuffer() );
+        DiscardData( _kdpEndToken );
+        return tcxt;
+      }
+      // The token spans blocks - copy it to a chunk of its own:
+      shared_ptr< _TyChar[] > spcToken = make_shared< _TyChar[] >( knchToken );
+      _CopyRange( m_posTokenStart, _kdpEndToken, spcToken.get() );
+      _TyTransportCtxt tcxt( m_posTokenStart, spcToken, _TyBuffer( spcToken.get(), knchToken ) );
+      DiscardData( _kdpEndToken );
+      return tcxt;
+    }
+  }
+  void DiscardData( const vtyDataPosition _kdpEndToken )
+  {
+    Assert( _kdpEndToken >= m_posTokenStart );
+    Assert( _kdpEndToken <= PosCurrent() );
+    m_posTokenStart = _kdpEndToken;
+    _SetPosCurrent( _kdpEndToken );
+    _ReleaseConsumed();
+  }
+  template < class t_TyString >
+  void GetCurTokenString( t_TyString & _rstr ) const
+  {
+    basic_string< _TyChar > strToken;
+    _GetRangeString( m_posTokenStart, PosCurrent(), strToken );
+    if constexpr ( sizeof( typename t_TyString::value_type ) == sizeof( _TyChar ) )
+      _rstr.assign( (typename t_TyString::value_type const *)strToken.c_str(), strToken.length() );
+    else
+      ConvertString( _rstr, strToken.c_str(), strToken.length() );
+  }
+  bool FSpanChars( const _TyData & _rdt, const _TyChar * _pszCharSet ) const
+  {
+    Assert( _rdt.FContainsSingleDataRange() );
+    AssertValidDataRange( _rdt );
+    basic_string< _TyChar > strRange;
+    _GetRangeString( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end(), strRange );
+    return strRange.length() == StrSpn( strRange.c_str(), strRange.length(), _pszCharSet );
+  }
+  bool FMatchChars( const _TyData & _rdt, const _TyChar * _pszMatch ) const
+  {
+    Assert( _rdt.FContainsSingleDataRange() );
+    AssertValidDataRange( _rdt );
+    basic_string< _TyChar > strRange;
+    _GetRangeString( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end(), strRange );
+    return strRange.end() == mismatch( strRange.begin(), strRange.end(), _pszMatch ).first;
+  }
+  void AssertValidDataRange( _TyData const & _rdt ) const
+  {
+#if ASSERTSENABLED
+    if ( !_rdt.FIsNull() )
+    {
+      if ( _rdt.FContainsSingleDataRange() )
+      {
+        _AssertValidRange( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end() );
+      }
+      else
+      {
+        _rdt.GetSegArrayDataRanges().ApplyContiguous( 0, _rdt.GetSegArrayDataRanges().NElements(),
+          [this]( const _l_data_typed_range * _pdtrBegin, const _l_data_typed_range * _pdtrEnd )
+          {
+            for( ; _pdtrEnd != _pdtrBegin; ++_pdtrBegin )
+            {
+              if ( !_pdtrBegin->FIsNull() )
+                _AssertValidRange( _pdtrBegin->begin(), _pdtrBegin->end() );
+            }
+          }
+        );
+      }
+    }
+#endif //ASSERTSENABLED
+  }
+protected:
+  // The derived class initializes the source and then calls this.
+  _l_transport_block( size_t _nbyBlock, size_t _nBlocksAhead )
+    : m_nbyBlock( (std::max)( _nbyBlock - _nbyBlock % sizeof( _TyChar ), sizeof( _TyChar ) ) ),
+      m_nBlocksAhead( (std::max)( _nBlocksAhead, size_t( 1 ) ) )
+  {
+  }
+  void _Start()
+  {
+    m_dqpibBlocks.clear();
+    m_dqpibBlocks.emplace_back( _PibGetFree() );
+    if ( !m_source.FSubmitRead( *m_dqpibBlocks.back() ) )
+      m_dqpibBlocks.back()->m_nbyValid = 0; // Empty input.
+    _WaitBlock( *m_dqpibBlocks.back(), 0 );
+    m_iBlockCur = 0;
+    m_posTokenStart = 0;
+    _SetPointers();
+    _SubmitAhead();
+  }
+  static const _TyChar * _PcBlockBegin( _l_input_block const & _rib )
+  {
+    return (const _TyChar *)_rib.m_rgby.get();
+  }
+  static size_t _NCharsBlock( _l_input_block const & _rib )
+  {
+    return _rib.m_nbyValid / sizeof( _TyChar );
+  }
+  void _SetPointers()
+  {
+    _l_input_block const & rib = *m_dqpibBlocks[ m_iBlockCur ];
+    m_pcCur = _PcBlockBegin( rib );
+    m_pcEnd = m_pcCur + _NCharsBlock( rib );
+  }
+  shared_ptr< _l_input_block > _PibGetFree()
+  {
+    if ( m_rgpibFree.empty() )
+      return make_shared< _l_input_block >( m_nbyBlock );
+    shared_ptr< _l_input_block > pib( std::move( m_rgpibFree.back() ) );
+    m_rgpibFree.pop_back();
+    return pib;
+  }
+  // Return the index of the block containing _pos - which must have been read. The end of the last read block is in that block.
+  size_t _IBlockContaining( vtyDataPosition _pos ) const
+  {
+    Assert( _pos >= m_dqpibBlocks.front()->m_posBegin );
+    size_t iBlock = 0;
+    for ( ; ( iBlock < m_iBlockCur ) && ( _pos >= m_dqpibBlocks[ iBlock + 1 ]->m_posBegin ); ++iBlock )
+      ;
+    return iBlock;
+  }
+  void _WaitBlock( _l_input_block & _rib, vtyDataPosition _posBegin )
+  {
+    if ( _rib.m_fPending )
+      m_source.WaitRead( _rib );
+    VerifyThrowSz( !( _rib.m_nbyValid % sizeof( _TyChar ) ), "Input length is not a multiple of the character size." );
+    _rib.m_posBegin = _posBegin;
+  }
+  // Keep m_nBlocksAhead reads submitted beyond the current block.
+  void _SubmitAhead()
+  {
+    while ( ( m_dqpibBlocks.size() - 1 - m_iBlockCur ) < m_nBlocksAhead )
+    {
+      shared_ptr< _l_input_block > pib( _PibGetFree() );
+      if ( !m_source.FSubmitRead( *pib ) )
+      {
+        m_rgpibFree.emplace_back( std::move( pib ) );
+        return;
+      }
+      m_dqpibBlocks.emplace_back( std::move( pib ) );
+    }
+  }
+  // The current block is exhausted - move to the next one.
+  bool _FNextBlock()
+  {
+    Assert( m_pcCur == m_pcEnd );
+    if ( m_iBlockCur + 1 == m_dqpibBlocks.size() )
+      return false; // eof.
+    _l_input_block const & ribPrev = *m_dqpibBlocks[ m_iBlockCur ];
+    vtyDataPosition posBegin = ribPrev.m_posBegin + _NCharsBlock( ribPrev );
+    ++m_iBlockCur;
+    _WaitBlock( *m_dqpibBlocks[ m_iBlockCur ], posBegin );
+    _SetPointers();
+    _SubmitAhead();
+    return m_pcCur != m_pcEnd;
+  }
+  // Move the current position back to _pos - we only ever move back so the blocks involved all have positions.
+  void _SetPosCurrent( vtyDataPosition _pos )
+  {
+    Assert( _pos >= m_dqpibBlocks.front()->m_posBegin );
+    Assert( _pos <= PosCurrent() );
+    while ( m_iBlockCur && ( _pos < m_dqpibBlocks[ m_iBlockCur ]->m_posBegin ) )
+      --m_iBlockCur;
+    _SetPointers();
+    m_pcCur += size_t( _pos - m_dqpibBlocks[ m_iBlockCur ]->m_posBegin );
+    Assert( m_pcCur <= m_pcEnd );
+  }
+  // Release the blocks wholly before the token start. Blocks still referenced by tokens are left to them.
+  void _ReleaseConsumed()
+  {
+    while ( m_iBlockCur && ( m_dqpibBlocks[ 1 ]->m_posBegin <= m_posTokenStart ) )
+    {
+      if ( 1 == m_dqpibBlocks.front().use_count() )
+        m_rgpibFree.emplace_back( std::move( m_dqpibBlocks.front() ) );
+      m_dqpibBlocks.pop_front();
+      --m_iBlockCur;
+    }
+    _SubmitAhead();
+  }
+  // Copy [_posBegin,_posEnd) - which must have been read - to _pcDest, switching endian as needed.
+  void _CopyRange( vtyDataPosition _posBegin, vtyDataPosition _posEnd, _TyChar * _pcDest ) const
+  {
+    _TyChar * const pcDestBegin = _pcDest;
+    for ( size_t iBlock = 0; ( iBlock <= m_iBlockCur ) && ( _posBegin < _posEnd ); ++iBlock )
+    {
+      _l_input_block const & rib = *m_dqpibBlocks[ iBlock ];
+      vtyDataPosition posBlockEnd = rib.m_posBegin + _NCharsBlock( rib );
+      if ( _posBegin >= posBlockEnd )
+        continue;
+      size_t nch = size_t( (std::min)( _posEnd, posBlockEnd ) - _posBegin );
+      memcpy( _pcDest, _PcBlockBegin( rib ) + ( _posBegin - rib.m_posBegin ), nch * sizeof( _TyChar ) );
+      _pcDest += nch;
+      _posBegin += nch;
+    }
+    Assert( _posBegin == _posEnd );
+    if ( s_kfSwitchEndian )
+      SwitchEndian( pcDestBegin, _pcDest - pcDestBegin );
+  }
+  void _GetRangeString( vtyDataPosition _posBegin, vtyDataPosition _posEnd, basic_string< _TyChar > & _rstr ) const
+  {
+    _rstr.resize( size_t( _posEnd - _posBegin ) );
+    if ( _posEnd != _posBegin )
+      _CopyRange( _posBegin, _posEnd, &_rstr[0] );
+  }
+  void _AssertValidRange( vtyDataPosition _posBegin, vtyDataPosition _posEnd ) const
+  {
+#if ASSERTSENABLED
+    Assert( _posEnd >= _posBegin );
+    Assert( _posBegin >= m_posTokenStart );
+    Assert( _posEnd <= PosCurrent() );
+#endif //ASSERTSENABLED
+  }
+  // Declared before the source so that the source is destroyed first - it must not be writing to freed blocks.
+  deque< shared_ptr< _l_input_block > > m_dqpibBlocks; // From the block containing the token start through those submitted ahead.
+  vector< shared_ptr< _l_input_block > > m_rgpibFree;
+  _TySource m_source;
+  size_t m_iBlockCur{0}; // The block containing the current position.
+  const _TyChar * m_pcCur{nullptr};
+  const _TyChar * m_pcEnd{nullptr};
+  vtyDataPosition m_posTokenStart{0};
+  size_t m_nbyBlock;
+  size_t m_nBlocksAhead;
+};
+
+// _l_transport_readahead:
+// Transport reading a regular file a block at a time with reads submitted ahead of the analyzer. With LXOBJ_IO_URING these
+//  are asynchronous via io_uring - falling back to pread() if io_uring isn't available at runtime - otherwise pread() is used.
+#ifdef LXOBJ_IO_URING
+typedef _l_read_source_uring _l_read_source_readahead;
+#else //!LXOBJ_IO_URING
+typedef _l_read_source_fd _l_read_source_readahead;
+#endif //!LXOBJ_IO_URING
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_readahead : public _l_transport_block< t_TyChar, _l_read_source_readahead, t_TyBoolSwitchEndian >
+{
+  typedef _l_transport_readahead _TyThis;
+  typedef _l_transport_block< t_TyChar, _l_read_source_readahead, t_TyBoolSwitchEndian > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+
+  _l_transport_readahead() = delete;
+  _l_transport_readahead( _l_transport_readahead const & ) = delete;
+  _l_transport_readahead & operator =( _l_transport_readahead const & ) = delete;
+  _l_transport_readahead( _l_transport_readahead && ) = default;
+  // Our old file and blocks go away with acquire - whose destructor waits for their reads first.
+  _l_transport_readahead & operator =( _l_transport_readahead && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  ~_l_transport_readahead()
+  {
+    m_source.DrainReads(); // m_file is closed before the base is destroyed.
+  }
+  void swap( _TyThis & _r )
+  {
+    _TyBase::swap( _r );
+    std::swap( m_file, _r.m_file );
+  }
+
+  _l_transport_readahead( const char * _pszFileName, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    PrepareErrNo();
+    vtyFileHandle hFile = OpenReadOnlyFile( _pszFileName );
+    if ( vkhInvalidFileHandle == hFile )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "Open of [%s] failed.", _pszFileName );
+    m_file.SetHFile( hFile, true );
+    _Init();
+  }
+  // We read starting at the current seek position of the file - as _l_transport_file.
+  _l_transport_readahead( FileObj & _rfoFile, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    VerifyThrowSz( _rfoFile.FIsOpen(), "Caller should pass an open file..." );
+    m_file = std::move( _rfoFile );
+    _Init();
+  }
+protected:
+  using _TyBase::m_source;
+  using _TyBase::m_nBlocksAhead;
+  void _Init()
+  {
+    vtyHandleAttr attrHandle;
+    int iGetAttrRtn = GetHandleAttrs( m_file.HFileGet(), attrHandle );
+    if ( !!iGetAttrRtn )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "GetHandleAttrs() of hFile[0x%zx] failed.", (size_t)(m_file.HFileGet()) );
+    VerifyThrowSz( FIsRegularFile_HandleAttr( attrHandle ), "_l_transport_readahead requires a regular file - use _l_transport_file for pipes and ttys." );
+    uint64_t nbyBegin = (uint64_t)NFileSeekAndThrow( m_file.HFileGet(), 0, vkSeekCur );
+    uint64_t nbyEnd = (uint64_t)NFileSeekAndThrow( m_file.HFileGet(), 0, vkSeekEnd );
+    (void)NFileSeekAndThrow( m_file.HFileGet(), nbyBegin, vkSeekBegin );
+    VerifyThrowSz( !( nbyBegin % sizeof( _TyChar ) ), "Current offset in file is not a multiple of a character byte length." );
+    VerifyThrowSz( !( ( nbyEnd - nbyBegin ) % sizeof( _TyChar ) ), "File length is not a multiple of a character byte length." );
+#ifdef LXOBJ_IO_URING
+    m_source.Init( m_file.HFileGet(), nbyBegin, nbyEnd, unsigned( 2 * m_nBlocksAhead + 2 ) );
+#else //!LXOBJ_IO_URING
+    m_source.Init( m_file.HFileGet(), nbyBegin, nbyEnd );
+#endif //!LXOBJ_IO_URING
+    (void)posix_fadvise( m_file.HFileGet(), (off_t)nbyBegin, (off_t)( nbyEnd - nbyBegin ), POSIX_FADV_SEQUENTIAL );
+    _TyBase::_Start();
+  }
+  FileObj m_file;
+};
+
+// _l_transport_file_chunked:
+// Transport reading any file descriptor - as _l_transport_file - into refcounted blocks so that tokens reference the input
+//  rather than copying it. Each read fills a block unless the input ends, so this isn't for interactive ttys.
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_file_chunked : public _l_transport_block< t_TyChar, _l_read_source_stream, t_TyBoolSwitchEndian >
+{
+  typedef _l_transport_file_chunked _TyThis;
+  typedef _l_transport_block< t_TyChar, _l_read_source_stream, t_TyBoolSwitchEndian > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+
+  _l_transport_file_chunked() = delete;
+  _l_transport_file_chunked( _l_transport_file_chunked const & ) = delete;
+  _l_transport_file_chunked & operator =( _l_transport_file_chunked const & ) = delete;
+  _l_transport_file_chunked( _l_transport_file_chunked && ) = default;
+  _l_transport_file_chunked & operator =( _l_transport_file_chunked && ) = default;
+
+  _l_transport_file_chunked( const char * _pszFileName, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    PrepareErrNo();
+    vtyFileHandle hFile = OpenReadOnlyFile( _pszFileName );
+    if ( vkhInvalidFileHandle == hFile )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "Open of [%s] failed.", _pszFileName );
+    m_file.SetHFile( hFile, true );
+    _Init();
+  }
+  // We read starting at the current seek position of the file.
+  _l_transport_file_chunked( FileObj & _rfoFile, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    VerifyThrowSz( _rfoFile.FIsOpen(), "Caller should pass an open file..." );
+    m_file = std::move( _rfoFile );
+    _Init();
+  }
+  // Attach to an hFile like STDIN - in which case you would set _fOwnFd to false.
+  _l_transport_file_chunked( vtyFileHandle _hFile, bool _fOwnFd = false, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead ),
+      m_file( _hFile, _fOwnFd )
+  {
+    _Init();
+  }
+protected:
+  using _TyBase::m_source;
+  void _Init()
+  {
+    m_source.Init( m_file.HFileGet() );
+    _TyBase::_Start();
+  }
+  FileObj m_file;
+};
+
+__LEXOBJ_END_NAMESPACE
+
+#endif //!WIN32
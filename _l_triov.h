@@ -0,0 +1,290 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_triov.h
+// Scatter-gather transport for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// _l_transport_segmented reads a sequence of non-contiguous memory segments - e.g. an iovec chain from the network layer -
+//  as if they were one contiguous input. As with _l_transport_fixedmem the memory belongs to the caller and must outlive the
+//  tokens. Tokens lying within one segment reference it directly, tokens that straddle a segment boundary are copied - both
+//  are returned in a _l_transport_chunk_ctxt. When switching endian tokens are copied into a _l_transport_backed_ctxt.
+// Position 0 is the first character of the first segment. Each segment must contain a whole number of characters.
+
+#ifndef WIN32
+#include <sys/uio.h>
+#endif //!WIN32
+#include "_l_transport.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+// _l_transport_segmented:
+// Transport over a chain of memory segments.
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_segmented : public _l_transport_base< t_TyChar >
+{
+  typedef _l_transport_segmented _TyThis;
+  typedef _l_transport_base< t_TyChar > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+  typedef t_TyBoolSwitchEndian _TyBoolSwitchEndian;
+  using typename _TyBase::_TyData;
+  static constexpr bool s_kfSwitchEndian = _TyBoolSwitchEndian::value;
+  using _TyTransportCtxt = typename std::conditional< s_kfSwitchEndian, _l_transport_backed_ctxt< _TyChar >, _l_transport_chunk_ctxt< _TyChar > >::type;
+  typedef _l_action_object_base< _TyChar, false > _TyAxnObjBase;
+  typedef pair< const void *, size_t > _TySegment; // ( pointer, length in bytes ).
+
+  ~_l_transport_segmented() = default;
+  _l_transport_segmented() = delete;
+  _l_transport_segmented( _l_transport_segmented const & ) = delete;
+  _l_transport_segmented & operator =( _l_transport_segmented const & ) = delete;
+  _l_transport_segmented( _l_transport_segmented && ) = default;
+  _l_transport_segmented & operator =( _l_transport_segmented && ) = default;
+
+  _l_transport_segmented( const _TySegment * _rgseg, size_t _nSegs )
+  {
+    for ( const _TySegment * psegCur = _rgseg, * const psegEnd = _rgseg + _nSegs; psegEnd != psegCur; ++psegCur )
+      _AddSegment( psegCur->first, psegCur->second );
+    _Start();
+  }
+#ifndef WIN32
+  _l_transport_segmented( const struct iovec * _rgiov, size_t _nIovs )
+  {
+    for ( const struct iovec * piovCur = _rgiov, * const piovEnd = _rgiov + _nIovs; piovEnd != piovCur; ++piovCur )
+      _AddSegment( piovCur->iov_base, piovCur->iov_len );
+    _Start();
+  }
+#endif //!WIN32
+
+  static EFileCharacterEncoding GetSupportedCharacterEncoding()
+  {
+    return GetCharacterEncoding< _TyChar, _TyBoolSwitchEndian >();
+  }
+  bool FDependentTransportContexts() const
+  {
+    return false;
+  }
+  void AssertValid() const
+  {
+#if ASSERTSENABLED
+    Assert( !m_rgbufSegs.empty() );
+    Assert( m_rgbufSegs.size() == m_rgposSegBegin.size() );
+    Assert( m_iSegCur < m_rgbufSegs.size() );
+    Assert( m_posTokenStart <= PosCurrent() );
+#endif //ASSERTSENABLED
+  }
+  vtyDataPosition PosTokenStart() const
+  {
+    return m_posTokenStart;
+  }
+  vtyDataPosition PosCurrent() const
+  {
+    return m_rgposSegBegin[ m_iSegCur ] + ( m_pcCur - m_rgbufSegs[ m_iSegCur ].begin() );
+  }
+  bool FAtTokenStart() const
+  {
+    return PosCurrent() == m_posTokenStart;
+  }
+  void ResetToTokenStart()
+  {
+    _SetPosCurrent( m_posTokenStart );
+  }
+  // Return the current character and advance the position.
+  bool FGetChar( _TyChar & _rc )
+  {
+    if ( m_pcCur == m_pcEnd )
+    {
+      if ( m_iSegCur + 1 == m_rgbufSegs.size() )
+        return false;
+      ++m_iSegCur;
+      m_pcCur = m_rgbufSegs[ m_iSegCur ].begin();
+      m_pcEnd = m_rgbufSegs[ m_iSegCur ].end();
+    }
+    _rc = *m_pcCur++;
+    if ( s_kfSwitchEndian )
+      SwitchEndian( _rc );
+    return true;
+  }
+  template < class t_TyToken, class t_TyValue, class t_TyUserObj >
+  void GetPToken( const _TyAxnObjBase * _paobCurToken, const vtyDataPosition _kdpEndToken,
+                  t_TyValue & _rvalue, t_TyUserObj & _ruoUserObj,
+                  unique_ptr< t_TyToken > & _rupToken )
+  {
+    typedef typename t_TyToken::_TyValue _TyValue;
+    static_assert( is_same_v< t_TyValue, _TyValue > );
+    typedef typename t_TyToken::_TyUserContext _TyUserContext;
+    typedef typename _TyUserContext::_TyUserObj _TyUserObj;
+    static_assert( is_same_v< t_TyUserObj, _TyUserObj > );
+    _TyUserContext ucxt( _ruoUserObj, CtxtEatCurrentToken( _kdpEndToken ) );
+    unique_ptr< t_TyToken > upToken = make_unique< t_TyToken >( std::move( ucxt ), std::move( _rvalue ), _paobCurToken );
+    upToken.swap( _rupToken );
+  }
+  _TyTransportCtxt CtxtEatCurrentToken( const vtyDataPosition _kdpEndToken )
+  {
+    Assert( _kdpEndToken >= m_posTokenStart );
+    Assert( _kdpEndToken <= PosCurrent() );
+    typedef typename _TyTransportCtxt::_TyBuffer _TyBuffer;
+    const size_t knchToken = size_t( _kdpEndToken - m_posTokenStart );
+    if constexpr ( s_kfSwitchEndian )
+    {
+      _TyTransportCtxt tcxt( m_posTokenStart, _TyBuffer( knchToken ) );
+      _CopyRange( m_posTokenStart, _kdpEndToken, tcxt.GetTokenBuffer().begin() );
+      DiscardData( _kdpEndToken );
+      return tcxt;
+    }
+    else
+    {
+      typedef typename _TyTransportCtxt::_TyChunkPtr _TyChunkPtr;
+      size_t iSeg = _ISegContaining( m_posTokenStart );
+      if ( _kdpEndToken <= m_rgposSegBegin[ iSeg ] + m_rgbufSegs[ iSeg ].length() )
+      {
+        // Zero-copy - the caller owns the segment so we reference it without an owner:
+        const _TyChar * pcToken = m_rgbufSegs[ iSeg ].begin() + size_t( m_posTokenStart - m_rgposSegBegin[ iSeg ] );
+        _TyTransportCtxt tcxt( m_posTokenStart, _TyChunkPtr( _TyChunkPtr(), pcToken ), knchToken ? _TyBuffer( pcToken, knchToken ) : _TyBuffer() );
+        DiscardData( _kdpEndToken );
+        return tcxt;
+      }
+      // The token straddles segments - copy it to a chunk of its own:
+      shared_ptr< _TyChar[] > spcToken = make_shared< _TyChar[] >( knchToken );
+      _CopyRange( m_posTokenStart, _kdpEndToken, spcToken.get() );
+      _TyTransportCtxt tcxt( m_posTokenStart, spcToken, _TyBuffer( spcToken.get(), knchToken ) );
+      DiscardData( _kdpEndToken );
+      return tcxt;
+    }
+  }
+  void DiscardData( const vtyDataPosition _kdpEndToken )
+  {
+    Assert( _kdpEndToken >= m_posTokenStart );
+    Assert( _kdpEndToken <= PosCurrent() );
+    m_posTokenStart = _kdpEndToken;
+    _SetPosCurrent( _kdpEndToken );
+  }
+  template < class t_TyString >
+  void GetCurTokenString( t_TyString & _rstr ) const
+  {
+    basic_string< _TyChar > strToken;
+    _GetRangeString( m_posTokenStart, PosCurrent(), strToken );
+    if constexpr ( sizeof( typename t_TyString::value_type ) == sizeof( _TyChar ) )
+      _rstr.assign( (typename t_TyString::value_type const *)strToken.c_str(), strToken.length() );
+    else
+      ConvertString( _rstr, strToken.c_str(), strToken.length() );
+  }
+  bool FSpanChars( const _TyData & _rdt, const _TyChar * _pszCharSet ) const
+  {
+    Assert( _rdt.FContainsSingleDataRange() );
+    AssertValidDataRange( _rdt );
+    basic_string< _TyChar > strRange;
+    _GetRangeString( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end(), strRange );
+    return strRange.length() == StrSpn( strRange.c_str(), strRange.length(), _pszCharSet );
+  }
+  bool FMatchChars( const _TyData & _rdt, const _TyChar * _pszMatch ) const
+  {
+    Assert( _rdt.FContainsSingleDataRange() );
+    AssertValidDataRange( _rdt );
+    basic_string< _TyChar > strRange;
+    _GetRangeString( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end(), strRange );
+    return strRange.end() == mismatch( strRange.begin(), strRange.end(), _pszMatch ).first;
+  }
+  void AssertValidDataRange( _TyData const & _rdt ) const
+  {
+#if ASSERTSENABLED
+    if ( !_rdt.FIsNull() )
+    {
+      if ( _rdt.FContainsSingleDataRange() )
+      {
+        _AssertValidRange( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end() );
+      }
+      else
+      {
+        _rdt.GetSegArrayDataRanges().ApplyContiguous( 0, _rdt.GetSegArrayDataRanges().NElements(),
+          [this]( const _l_data_typed_range * _pdtrBegin, const _l_data_typed_range * _pdtrEnd )
+          {
+            for( ; _pdtrEnd != _pdtrBegin; ++_pdtrBegin )
+            {
+              if ( !_pdtrBegin->FIsNull() )
+                _AssertValidRange( _pdtrBegin->begin(), _pdtrBegin->end() );
+            }
+          }
+        );
+      }
+    }
+#endif //ASSERTSENABLED
+  }
+protected:
+  typedef _l_fixed_buf< _TyChar > _TyBufSegment;
+  void _AddSegment( const void * _pv, size_t _nby )
+  {
+    VerifyThrowSz( !( _nby % sizeof( _TyChar ) ), "Segment length is not a multiple of the character size." );
+    if ( !_nby )
+      return; // Empty segments needn't be visited.
+    vtyDataPosition posBegin = m_rgbufSegs.empty() ? 0 : ( m_rgposSegBegin.back() + m_rgbufSegs.back().length() );
+    m_rgbufSegs.emplace_back( (const _TyChar *)_pv, _nby / sizeof( _TyChar ) );
+    m_rgposSegBegin.push_back( posBegin );
+  }
+  void _Start()
+  {
+    if ( m_rgbufSegs.empty() )
+    {
+      m_rgbufSegs.emplace_back(); // Empty input.
+      m_rgposSegBegin.push_back( 0 );
+    }
+    m_iSegCur = 0;
+    m_pcCur = m_rgbufSegs[ 0 ].begin();
+    m_pcEnd = m_rgbufSegs[ 0 ].end();
+    m_posTokenStart = 0;
+  }
+  // Return the index of the segment containing _pos. The end of the input is in the last segment.
+  size_t _ISegContaining( vtyDataPosition _pos ) const
+  {
+    Assert( _pos <= m_rgposSegBegin.back() + m_rgbufSegs.back().length() );
+    return size_t( upper_bound( m_rgposSegBegin.begin() + 1, m_rgposSegBegin.end(), _pos ) - m_rgposSegBegin.begin() ) - 1;
+  }
+  void _SetPosCurrent( vtyDataPosition _pos )
+  {
+    m_iSegCur = _ISegContaining( _pos );
+    m_pcCur = m_rgbufSegs[ m_iSegCur ].begin() + size_t( _pos - m_rgposSegBegin[ m_iSegCur ] );
+    m_pcEnd = m_rgbufSegs[ m_iSegCur ].end();
+  }
+  // Copy [_posBegin,_posEnd) to _pcDest, switching endian as needed.
+  void _CopyRange( vtyDataPosition _posBegin, vtyDataPosition _posEnd, _TyChar * _pcDest ) const
+  {
+    _TyChar * const pcDestBegin = _pcDest;
+    for ( size_t iSeg = _ISegContaining( _posBegin ); _posBegin < _posEnd; ++iSeg )
+    {
+      Assert( iSeg < m_rgbufSegs.size() );
+      size_t nch = size_t( (std::min)( _posEnd, m_rgposSegBegin[ iSeg ] + m_rgbufSegs[ iSeg ].length() ) - _posBegin );
+      memcpy( _pcDest, m_rgbufSegs[ iSeg ].begin() + size_t( _posBegin - m_rgposSegBegin[ iSeg ] ), nch * sizeof( _TyChar ) );
+      _pcDest += nch;
+      _posBegin += nch;
+    }
+    if ( s_kfSwitchEndian )
+      SwitchEndian( pcDestBegin, _pcDest - pcDestBegin );
+  }
+  void _GetRangeString( vtyDataPosition _posBegin, vtyDataPosition _posEnd, basic_string< _TyChar > & _rstr ) const
+  {
+    _rstr.resize( size_t( _posEnd - _posBegin ) );
+    if ( _posEnd != _posBegin )
+      _CopyRange( _posBegin, _posEnd, &_rstr[0] );
+  }
+  void _AssertValidRange( vtyDataPosition _posBegin, vtyDataPosition _posEnd ) const
+  {
+#if ASSERTSENABLED
+    Assert( _posEnd >= _posBegin );
+    Assert( _posBegin >= m_posTokenStart );
+    Assert( _posEnd <= PosCurrent() );
+#endif //ASSERTSENABLED
+  }
+  vector< _TyBufSegment > m_rgbufSegs;
+  vector< vtyDataPosition > m_rgposSegBegin; // The position of the first character of each segment.
+  size_t m_iSegCur{0};
+  const _TyChar * m_pcCur{nullptr};
+  const _TyChar * m_pcEnd{nullptr};
+  vtyDataPosition m_posTokenStart{0};
+};
+
+__LEXOBJ_END_NAMESPACE
@@ -0,0 +1,318 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_trutf.h
+// UTF-8 transcoding transport for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// _l_transport_utf8 lets a char16_t or char32_t analyzer read UTF-8 input without transcoding the whole input first. The
+//  UTF-8 is transcoded a block at a time into the refcounted blocks of _l_transport_block - so only the blocks from the
+//  token start through the read ahead are held in the wide encoding, and tokens reference the blocks as with
+//  _l_transport_file_chunked.
+// Positions are in code units of t_TyChar. NByteOffset() maps a position to the offset of its code point in the UTF-8 input.
+//  A checkpoint is kept for each block transcoded and the mapping rescans the UTF-8 from the checkpoint - it is meant for
+//  reporting locations, not for use per character.
+// Runs of ASCII are widened 16 bytes at a time - with SSE2 when available - the rest is decoded a code point at a time. There
+//  is no vectorized decoding of multibyte sequences.
+//  Invalid UTF-8 ( overlong forms, surrogates, truncated sequences, code points beyond U+10FFFF ) throws.
+
+#ifndef WIN32
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif //__SSE2__
+#include <sys/mman.h>
+#include "_l_trblk.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+// Selects the constructor of _l_transport_utf8 that opens a file by name - so that a char buffer and its length can't be
+//  taken for a file name and a block size.
+struct _l_utf8_file_tag
+{
+};
+
+// _l_read_source_utf8: Transcode UTF-8 in memory into blocks of t_TyChar. The memory must remain valid while transcoding.
+template < class t_TyChar >
+class _l_read_source_utf8
+{
+  typedef _l_read_source_utf8 _TyThis;
+public:
+  typedef t_TyChar _TyChar;
+  static_assert( ( sizeof( _TyChar ) == 2 ) || ( sizeof( _TyChar ) == 4 ), "UTF-8 is transcoded to UTF-16 or UTF-32." );
+
+  _l_read_source_utf8() = default;
+  _l_read_source_utf8( _l_read_source_utf8 const & ) = delete;
+  _l_read_source_utf8 & operator =( _l_read_source_utf8 const & ) = delete;
+  _l_read_source_utf8( _l_read_source_utf8 && ) = default;
+  _l_read_source_utf8 & operator =( _l_read_source_utf8 && ) = default;
+
+  void Init( const uint8_t * _pbyBegin, size_t _nby )
+  {
+    m_pbyBegin = m_pbyCur = _pbyBegin;
+    m_pbyEnd = _pbyBegin + _nby;
+    m_nchOutput = 0;
+    m_rgcpCheckpoints.clear();
+  }
+  bool FSubmitRead( _l_input_block & _rib )
+  {
+    Assert( !_rib.m_fPending );
+    if ( m_pbyEnd == m_pbyCur )
+      return false;
+    _rib.m_nbyRequest = _rib.m_nbyCapacity - _rib.m_nbyCapacity % sizeof( _TyChar );
+    _rib.m_nbyValid = 0;
+    _rib.m_fPending = true;
+    return true;
+  }
+  // Reads happen in WaitRead() - nothing is in flight.
+  void DrainReads()
+  {
+  }
+  void WaitRead( _l_input_block & _rib )
+  {
+    Assert( _rib.m_fPending );
+    _rib.m_nbyOffset = m_nchOutput * sizeof( _TyChar );
+    if ( m_pbyEnd != m_pbyCur )
+      m_rgcpCheckpoints.emplace_back( m_nchOutput, uint64_t( m_pbyCur - m_pbyBegin ) );
+    size_t nch = NTranscode( m_pbyCur, m_pbyEnd, (_TyChar *)_rib.m_rgby.get(), _rib.m_nbyRequest / sizeof( _TyChar ) );
+    _rib.m_nbyValid = nch * sizeof( _TyChar );
+    m_nchOutput += nch;
+    _rib.m_fPending = false;
+  }
+  // Return the offset in the UTF-8 input of the code point containing the code unit at _pos.
+  uint64_t NByteOffset( vtyDataPosition _pos ) const
+  {
+    VerifyThrowSz( _pos <= m_nchOutput, "Position[%llu] hasn't been transcoded.", (unsigned long long)_pos );
+    if ( m_rgcpCheckpoints.empty() || ( _pos == m_nchOutput ) )
+      return uint64_t( m_pbyCur - m_pbyBegin );
+    typename vector< _TyCheckpoint >::const_iterator itcp = upper_bound( m_rgcpCheckpoints.begin(), m_rgcpCheckpoints.end(), _pos,
+      []( vtyDataPosition _posFind, _TyCheckpoint const & _rcp ) { return _posFind < _rcp.first; } );
+    Assert( m_rgcpCheckpoints.begin() != itcp );
+    --itcp;
+    vtyDataPosition posCur = itcp->first;
+    const uint8_t * pbyCur = m_pbyBegin + itcp->second;
+    for ( ;; )
+    {
+      const uint8_t * pbyCodePoint = pbyCur;
+      char32_t cp = _CpDecode( pbyCur, m_pbyEnd );
+      posCur += _NUnits( cp );
+      if ( posCur > _pos )
+        return uint64_t( pbyCodePoint - m_pbyBegin );
+    }
+  }
+  // Transcode from _rpbyCur until either the input or the output is exhausted - a code point whose code units don't all fit
+  //  is left for the next call. Returns the number of code units output.
+  static size_t NTranscode( const uint8_t *& _rpbyCur, const uint8_t * const _pbyEnd, _TyChar * const _pcOut, const size_t _nchOut )
+  {
+    const uint8_t * pbyCur = _rpbyCur;
+    _TyChar * pcCur = _pcOut;
+    _TyChar * const pcEnd = _pcOut + _nchOut;
+    while ( ( _pbyEnd != pbyCur ) && ( pcEnd != pcCur ) )
+    {
+      while ( ( ( _pbyEnd - pbyCur ) >= 16 ) && ( ( pcEnd - pcCur ) >= 16 ) && _FWidenAscii16( pbyCur, pcCur ) )
+      {
+        pbyCur += 16;
+        pcCur += 16;
+      }
+      if ( ( _pbyEnd == pbyCur ) || ( pcEnd == pcCur ) )
+        break;
+      if ( *pbyCur < 0x80 )
+      {
+        *pcCur++ = _TyChar( *pbyCur++ );
+        continue;
+      }
+      const uint8_t * pbyCodePoint = pbyCur;
+      char32_t cp = _CpDecode( pbyCur, _pbyEnd );
+      if ( ( sizeof( _TyChar ) == 2 ) && ( cp >= 0x10000 ) )
+      {
+        if ( ( pcEnd - pcCur ) < 2 )
+        {
+          pbyCur = pbyCodePoint; // Doesn't fit - leave it for the next block.
+          break;
+        }
+        cp -= 0x10000;
+        *pcCur++ = _TyChar( 0xD800 + ( cp >> 10 ) );
+        *pcCur++ = _TyChar( 0xDC00 + ( cp & 0x3FF ) );
+      }
+      else
+        *pcCur++ = _TyChar( cp );
+    }
+    _rpbyCur = pbyCur;
+    return pcCur - _pcOut;
+  }
+protected:
+  typedef pair< vtyDataPosition, uint64_t > _TyCheckpoint; // ( position, UTF-8 offset ) of the start of a block.
+  static size_t _NUnits( char32_t _cp )
+  {
+    return ( ( sizeof( _TyChar ) == 2 ) && ( _cp >= 0x10000 ) ) ? 2 : 1;
+  }
+  // If the 16 bytes at _pby are all ASCII then widen them to _pc and return true.
+  static bool _FWidenAscii16( const uint8_t * _pby, _TyChar * _pc )
+  {
+#ifdef __SSE2__
+    const __m128i kv = _mm_loadu_si128( (const __m128i *)_pby );
+    if ( _mm_movemask_epi8( kv ) )
+      return false;
+    const __m128i kvZero = _mm_setzero_si128();
+    const __m128i kvLo = _mm_unpacklo_epi8( kv, kvZero );
+    const __m128i kvHi = _mm_unpackhi_epi8( kv, kvZero );
+    if constexpr ( sizeof( _TyChar ) == 2 )
+    {
+      _mm_storeu_si128( (__m128i *)_pc, kvLo );
+      _mm_storeu_si128( (__m128i *)_pc + 1, kvHi );
+    }
+    else
+    {
+      _mm_storeu_si128( (__m128i *)_pc, _mm_unpacklo_epi16( kvLo, kvZero ) );
+      _mm_storeu_si128( (__m128i *)_pc + 1, _mm_unpackhi_epi16( kvLo, kvZero ) );
+      _mm_storeu_si128( (__m128i *)_pc + 2, _mm_unpacklo_epi16( kvHi, kvZero ) );
+      _mm_storeu_si128( (__m128i *)_pc + 3, _mm_unpackhi_epi16( kvHi, kvZero ) );
+    }
+    return true;
+#else //!__SSE2__
+    uint64_t rgu64[2];
+    memcpy( rgu64, _pby, sizeof( rgu64 ) );
+    if ( ( rgu64[0] | rgu64[1] ) & 0x8080808080808080ull )
+      return false;
+    for ( size_t nb = 0; nb < 16; ++nb )
+      _pc[ nb ] = _TyChar( _pby[ nb ] );
+    return true;
+#endif //!__SSE2__
+  }
+  // Decode the code point at _rpbyCur and advance past it.
+  static char32_t _CpDecode( const uint8_t *& _rpbyCur, const uint8_t * const _pbyEnd )
+  {
+    Assert( _pbyEnd != _rpbyCur );
+    const uint8_t * pbyCur = _rpbyCur;
+    uint8_t byLead = *pbyCur++;
+    if ( byLead < 0x80 )
+    {
+      _rpbyCur = pbyCur;
+      return byLead;
+    }
+    size_t nbyTrail;
+    char32_t cp;
+    char32_t cpMin;
+    if ( ( byLead & 0xE0 ) == 0xC0 )
+    {
+      nbyTrail = 1;
+      cp = byLead & 0x1F;
+      cpMin = 0x80;
+    }
+    else
+    if ( ( byLead & 0xF0 ) == 0xE0 )
+    {
+      nbyTrail = 2;
+      cp = byLead & 0x0F;
+      cpMin = 0x800;
+    }
+    else
+    {
+      VerifyThrowSz( ( byLead & 0xF8 ) == 0xF0, "Invalid UTF-8 lead byte[0x%02x].", (unsigned)byLead );
+      nbyTrail = 3;
+      cp = byLead & 0x07;
+      cpMin = 0x10000;
+    }
+    VerifyThrowSz( size_t( _pbyEnd - pbyCur ) >= nbyTrail, "Truncated UTF-8 sequence at the end of the input." );
+    for ( const uint8_t * const pbyTrailEnd = pbyCur + nbyTrail; pbyTrailEnd != pbyCur; ++pbyCur )
+    {
+      VerifyThrowSz( ( *pbyCur & 0xC0 ) == 0x80, "Invalid UTF-8 continuation byte[0x%02x].", (unsigned)*pbyCur );
+      cp = ( cp << 6 ) | ( *pbyCur & 0x3F );
+    }
+    VerifyThrowSz( ( cp >= cpMin ) && ( cp <= 0x10FFFF ) && ( ( cp < 0xD800 ) || ( cp > 0xDFFF ) ), "Invalid UTF-8 code point[0x%x].", (unsigned)cp );
+    _rpbyCur = pbyCur;
+    return cp;
+  }
+  const uint8_t * m_pbyBegin{nullptr};
+  const uint8_t * m_pbyCur{nullptr};
+  const uint8_t * m_pbyEnd{nullptr};
+  vtyDataPosition m_nchOutput{0};
+  vector< _TyCheckpoint > m_rgcpCheckpoints;
+};
+
+// _l_transport_utf8:
+// Transport reading UTF-8 - in memory or from a mapped file - as char16_t ( UTF-16 ) or char32_t ( UTF-32 ).
+template < class t_TyChar >
+class _l_transport_utf8 : public _l_transport_block< t_TyChar, _l_read_source_utf8< t_TyChar >, false_type >
+{
+  typedef _l_transport_utf8 _TyThis;
+  typedef _l_transport_block< t_TyChar, _l_read_source_utf8< t_TyChar >, false_type > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+
+  _l_transport_utf8() = delete;
+  _l_transport_utf8( _l_transport_utf8 const & ) = delete;
+  _l_transport_utf8 & operator =( _l_transport_utf8 const & ) = delete;
+  _l_transport_utf8( _l_transport_utf8 && ) = default;
+  _l_transport_utf8 & operator =( _l_transport_utf8 && ) = default;
+
+  // The caller's memory must remain valid until the input is exhausted. Pass a char buffer as ( const char8_t * ).
+  _l_transport_utf8( const char8_t * _pcUtf8, size_t _nbyUtf8, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = 1 )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    _Init( (const uint8_t *)_pcUtf8, _nbyUtf8 );
+  }
+  _l_transport_utf8( _l_utf8_file_tag, const char * _pszFileName, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = 1 )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    PrepareErrNo();
+    vtyFileHandle hFile = OpenReadOnlyFile( _pszFileName );
+    if ( vkhInvalidFileHandle == hFile )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "Open of [%s] failed.", _pszFileName );
+    FileObj foFile;
+    foFile.SetHFile( hFile, true );
+    _MapFile( foFile ); // The mapping remains valid after the file is closed.
+  }
+  // We map starting at the current seek position of the file - after any BOM.
+  _l_transport_utf8( FileObj & _rfoFile, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = 1 )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    VerifyThrowSz( _rfoFile.FIsOpen(), "Caller should pass an open file..." );
+    _MapFile( _rfoFile );
+  }
+  // We read UTF-8.
+  static EFileCharacterEncoding GetSupportedCharacterEncoding()
+  {
+    return GetCharacterEncoding< char, false_type >();
+  }
+  // Return the offset in the UTF-8 input of the code point containing the code unit at _pos.
+  uint64_t NByteOffset( vtyDataPosition _pos ) const
+  {
+    return m_source.NByteOffset( _pos );
+  }
+protected:
+  using _TyBase::m_source;
+  void _MapFile( FileObj & _rfoFile )
+  {
+    uint64_t u64MapAtPosition = (uint64_t)NFileSeekAndThrow( _rfoFile.HFileGet(), 0, vkSeekCur );
+    uint64_t u64SizeMapping;
+    FileMappingObj fmoFile( MapReadOnlyHandle( _rfoFile.HFileGet(), &u64SizeMapping, &u64MapAtPosition ) );
+    if ( !fmoFile.FIsOpen() )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "MapReadOnlyHandle() of handle[%llu] failed, u64SizeMapping[%llu].", (size_t)_rfoFile.HFileGet(), u64SizeMapping );
+    const uint8_t * pbyBegin = (const uint8_t *)fmoFile.Pby( (size_t)u64MapAtPosition ); // truncatable since MapReadOnlyHandle will leave this within a PAGE_SIZE.
+    const size_t knbyInput = size_t( u64SizeMapping - u64MapAtPosition );
+    m_fmoMappedFile.swap( fmoFile );
+    if ( knbyInput )
+    {
+      const uintptr_t kuPageMask = uintptr_t( sysconf( _SC_PAGESIZE ) ) - 1;
+      uint8_t * pbyAdvise = (uint8_t *)( uintptr_t( pbyBegin ) & ~kuPageMask );
+      (void)::madvise( pbyAdvise, knbyInput + size_t( pbyBegin - pbyAdvise ), MADV_SEQUENTIAL );
+    }
+    _Init( pbyBegin, knbyInput );
+  }
+  void _Init( const uint8_t * _pbyBegin, size_t _nby )
+  {
+    m_source.Init( _pbyBegin, _nby );
+    _TyBase::_Start();
+  }
+  FileMappingObj m_fmoMappedFile; // Only when we mapped the input.
+};
+
+__LEXOBJ_END_NAMESPACE
+
+#endif //!WIN32
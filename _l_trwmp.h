@@ -0,0 +1,338 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_trwmp.h
+// Windowed memory mapped transport for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// _l_transport_mapped maps the whole file. _l_transport_mapped_window maps a window of the file that slides forward as the
+//  token start advances, so the address space and page tables used are bounded by the window size regardless of the
+//  file size. The window always starts at or before the current token start so a token is contiguous however far it
+//  extends - the window grows if a token is longer than it. Windows are mapped MADV_SEQUENTIAL and the pages behind
+//  the token start are released with MADV_DONTNEED as they are consumed.
+// Since the window is unmapped as it moves the tokens are copied into _l_transport_backed_ctxt as in _l_transport_file.
+
+#ifndef WIN32
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include "_l_transport.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+static const size_t vknbyTransportMappedWindowSize = 256 * 1024 * 1024;
+static const size_t vknbyTransportMappedReleaseSize = 4 * 1024 * 1024; // Consumed pages are released in at least this size.
+
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+class _l_transport_mapped_window : public _l_transport_base< t_TyChar >
+{
+  typedef _l_transport_mapped_window _TyThis;
+  typedef _l_transport_base< t_TyChar > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+  typedef t_TyBoolSwitchEndian _TyBoolSwitchEndian;
+  using typename _TyBase::_TyData;
+  static constexpr bool s_kfSwitchEndian = _TyBoolSwitchEndian::value;
+  typedef _l_transport_backed_ctxt< _TyChar > _TyTransportCtxt;
+  typedef _l_action_object_base< _TyChar, false > _TyAxnObjBase;
+
+  _l_transport_mapped_window() = delete;
+  _l_transport_mapped_window( _l_transport_mapped_window const & ) = delete;
+  _l_transport_mapped_window & operator =( _l_transport_mapped_window const & ) = delete;
+  _l_transport_mapped_window( _l_transport_mapped_window && _rr )
+  {
+    swap( _rr );
+  }
+  _l_transport_mapped_window & operator =( _l_transport_mapped_window && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+    m_file.swap( _r.m_file );
+    std::swap( m_nbyFileBegin, _r.m_nbyFileBegin );
+    std::swap( m_nbyFileEnd, _r.m_nbyFileEnd );
+    std::swap( m_nbyWindow, _r.m_nbyWindow );
+    std::swap( m_pbyMap, _r.m_pbyMap );
+    std::swap( m_nbyMapOffset, _r.m_nbyMapOffset );
+    std::swap( m_nbyMap, _r.m_nbyMap );
+    std::swap( m_nbyReleased, _r.m_nbyReleased );
+    std::swap( m_pcTokenStart, _r.m_pcTokenStart );
+    std::swap( m_pcCur, _r.m_pcCur );
+    std::swap( m_pcEnd, _r.m_pcEnd );
+  }
+  ~_l_transport_mapped_window()
+  {
+    _Unmap();
+  }
+
+  // _nbyWindow: The size of the mapped window - rounded to the page size.
+  _l_transport_mapped_window( const char * _pszFileName, size_t _nbyWindow = vknbyTransportMappedWindowSize )
+  {
+    PrepareErrNo();
+    vtyFileHandle hFile = OpenReadOnlyFile( _pszFileName );
+    if ( vkhInvalidFileHandle == hFile )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "Open of [%s] failed.", _pszFileName );
+    m_file.SetHFile( hFile, true );
+    _Init( _nbyWindow );
+  }
+  // We map starting at the current seek position of the file - as _l_transport_mapped.
+  _l_transport_mapped_window( FileObj & _rfoFile, size_t _nbyWindow = vknbyTransportMappedWindowSize )
+  {
+    VerifyThrowSz( _rfoFile.FIsOpen(), "Caller should pass an open file..." );
+    m_file = std::move( _rfoFile );
+    _Init( _nbyWindow );
+  }
+  static EFileCharacterEncoding GetSupportedCharacterEncoding()
+  {
+    return GetCharacterEncoding< _TyChar, _TyBoolSwitchEndian >();
+  }
+  bool FDependentTransportContexts() const
+  {
+    return false; // The window moves - so contexts are always backed.
+  }
+  void AssertValid() const
+  {
+#if ASSERTSENABLED
+    Assert( m_pcTokenStart <= m_pcCur );
+    Assert( m_pcCur <= m_pcEnd );
+#endif //ASSERTSENABLED
+  }
+  vtyDataPosition PosTokenStart() const
+  {
+    return _PosFromPc( m_pcTokenStart );
+  }
+  vtyDataPosition PosCurrent() const
+  {
+    return _PosFromPc( m_pcCur );
+  }
+  bool FAtTokenStart() const
+  {
+    return m_pcCur == m_pcTokenStart;
+  }
+  void ResetToTokenStart()
+  {
+    m_pcCur = m_pcTokenStart;
+  }
+  // Return the current character and advance the position.
+  bool FGetChar( _TyChar & _rc )
+  {
+    if ( ( m_pcCur == m_pcEnd ) && !_FSlideWindow() )
+      return false;
+    _rc = *m_pcCur++;
+    if ( s_kfSwitchEndian )
+      SwitchEndian( _rc );
+    return true;
+  }
+  template < class t_TyToken, class t_TyValue, class t_TyUserObj >
+  void GetPToken( const _TyAxnObjBase * _paobCurToken, const vtyDataPosition _kdpEndToken,
+                  t_TyValue & _rvalue, t_TyUserObj & _ruoUserObj,
+                  unique_ptr< t_TyToken > & _rupToken )
+  {
+    typedef typename t_TyToken::_TyValue _TyValue;
+    static_assert( is_same_v< t_TyValue, _TyValue > );
+    typedef typename t_TyToken::_TyUserContext _TyUserContext;
+    typedef typename _TyUserContext::_TyUserObj _TyUserObj;
+    static_assert( is_same_v< t_TyUserObj, _TyUserObj > );
+    _TyUserContext ucxt( _ruoUserObj, CtxtEatCurrentToken( _kdpEndToken ) );
+    unique_ptr< t_TyToken > upToken = make_unique< t_TyToken >( std::move( ucxt ), std::move( _rvalue ), _paobCurToken );
+    upToken.swap( _rupToken );
+  }
+  _TyTransportCtxt CtxtEatCurrentToken( const vtyDataPosition _kdpEndToken )
+  {
+    const _TyChar * pcEndToken = _PcFromPos( _kdpEndToken );
+    typedef typename _TyTransportCtxt::_TyBuffer _TyBuffer;
+    _TyTransportCtxt tcxt( PosTokenStart(), _TyBuffer( m_pcTokenStart, size_t( pcEndToken - m_pcTokenStart ) ) );
+    if ( s_kfSwitchEndian )
+      SwitchEndian( tcxt.GetTokenBuffer().begin(), tcxt.GetTokenBuffer().end() );
+    DiscardData( _kdpEndToken );
+    return tcxt;
+  }
+  void DiscardData( const vtyDataPosition _kdpEndToken )
+  {
+    m_pcTokenStart = m_pcCur = _PcFromPos( _kdpEndToken );
+    _ReleaseConsumed();
+  }
+  template < class t_TyString >
+  void GetCurTokenString( t_TyString & _rstr ) const
+  {
+    basic_string< _TyChar > strToken( m_pcTokenStart, m_pcCur - m_pcTokenStart );
+    if ( s_kfSwitchEndian && strToken.length() )
+      SwitchEndian( &strToken[0], strToken.length() );
+    if constexpr ( sizeof( typename t_TyString::value_type ) == sizeof( _TyChar ) )
+      _rstr.assign( (typename t_TyString::value_type const *)strToken.c_str(), strToken.length() );
+    else
+      ConvertString( _rstr, strToken.c_str(), strToken.length() );
+  }
+  bool FSpanChars( const _TyData & _rdt, const _TyChar * _pszCharSet ) const
+  {
+    Assert( _rdt.FContainsSingleDataRange() );
+    AssertValidDataRange( _rdt );
+    basic_string< _TyChar > strRange;
+    _GetRangeString( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end(), strRange );
+    return strRange.length() == StrSpn( strRange.c_str(), strRange.length(), _pszCharSet );
+  }
+  bool FMatchChars( const _TyData & _rdt, const _TyChar * _pszMatch ) const
+  {
+    Assert( _rdt.FContainsSingleDataRange() );
+    AssertValidDataRange( _rdt );
+    basic_string< _TyChar > strRange;
+    _GetRangeString( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end(), strRange );
+    return strRange.end() == mismatch( strRange.begin(), strRange.end(), _pszMatch ).first;
+  }
+  void AssertValidDataRange( _TyData const & _rdt ) const
+  {
+#if ASSERTSENABLED
+    if ( !_rdt.FIsNull() )
+    {
+      if ( _rdt.FContainsSingleDataRange() )
+      {
+        _AssertValidRange( _rdt.DataRangeGetSingle().begin(), _rdt.DataRangeGetSingle().end() );
+      }
+      else
+      {
+        _rdt.GetSegArrayDataRanges().ApplyContiguous( 0, _rdt.GetSegArrayDataRanges().NElements(),
+          [this]( const _l_data_typed_range * _pdtrBegin, const _l_data_typed_range * _pdtrEnd )
+          {
+            for( ; _pdtrEnd != _pdtrBegin; ++_pdtrBegin )
+            {
+              if ( !_pdtrBegin->FIsNull() )
+                _AssertValidRange( _pdtrBegin->begin(), _pdtrBegin->end() );
+            }
+          }
+        );
+      }
+    }
+#endif //ASSERTSENABLED
+  }
+protected:
+  static size_t _NbyPage()
+  {
+    static const size_t s_knbyPage = (size_t)sysconf( _SC_PAGESIZE );
+    return s_knbyPage;
+  }
+  void _Init( size_t _nbyWindow )
+  {
+    vtyHandleAttr attrHandle;
+    int iGetAttrRtn = GetHandleAttrs( m_file.HFileGet(), attrHandle );
+    if ( !!iGetAttrRtn )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "GetHandleAttrs() of hFile[0x%zx] failed.", (size_t)(m_file.HFileGet()) );
+    VerifyThrowSz( FIsRegularFile_HandleAttr( attrHandle ), "_l_transport_mapped_window requires a regular file." );
+    m_nbyFileBegin = (uint64_t)NFileSeekAndThrow( m_file.HFileGet(), 0, vkSeekCur );
+    m_nbyFileEnd = (uint64_t)NFileSeekAndThrow( m_file.HFileGet(), 0, vkSeekEnd );
+    (void)NFileSeekAndThrow( m_file.HFileGet(), m_nbyFileBegin, vkSeekBegin );
+    VerifyThrowSz( !( m_nbyFileBegin % sizeof( _TyChar ) ), "Current offset in file is not a multiple of a character byte length." );
+    VerifyThrowSz( !( ( m_nbyFileEnd - m_nbyFileBegin ) % sizeof( _TyChar ) ), "File length is not a multiple of a character byte length." );
+    m_nbyWindow = (std::max)( ( _nbyWindow + _NbyPage() - 1 ) / _NbyPage(), size_t( 1 ) ) * _NbyPage();
+    _Map( m_nbyFileBegin, 0 );
+  }
+  // Map the window that starts with the page containing _nbyTokenStart and contains at least _nbyNeeded bytes after it.
+  //  m_pcTokenStart and m_pcCur are set relative to the new window by the caller.
+  void _Map( uint64_t _nbyTokenStart, size_t _nbyNeeded )
+  {
+    uint64_t nbyMapOffset = _nbyTokenStart - ( _nbyTokenStart % _NbyPage() );
+    size_t nbyMap = m_nbyWindow;
+    size_t nbyLead = size_t( _nbyTokenStart - nbyMapOffset );
+    while ( nbyMap < nbyLead + _nbyNeeded + ( m_nbyWindow / 2 ) ) // Leave room to read ahead in the window.
+      nbyMap += m_nbyWindow;
+    nbyMap = (size_t)(std::min)( (uint64_t)nbyMap, m_nbyFileEnd - nbyMapOffset );
+    uint8_t * pbyMap = nullptr;
+    if ( nbyMap )
+    {
+      PrepareErrNo();
+      void * pv = ::mmap( nullptr, nbyMap, PROT_READ, MAP_SHARED, m_file.HFileGet(), (off_t)nbyMapOffset );
+      if ( MAP_FAILED == pv )
+        THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "mmap() of hFile[0x%zx] offset[%llu] length[%zu] failed.", (size_t)(m_file.HFileGet()), (unsigned long long)nbyMapOffset, nbyMap );
+      pbyMap = (uint8_t *)pv;
+      (void)::madvise( pv, nbyMap, MADV_SEQUENTIAL );
+    }
+    _Unmap();
+    m_pbyMap = pbyMap;
+    m_nbyMapOffset = nbyMapOffset;
+    m_nbyMap = nbyMap;
+    m_nbyReleased = 0;
+    m_pcTokenStart = m_pcCur = (const _TyChar *)( m_pbyMap + nbyLead );
+    m_pcEnd = (const _TyChar *)( m_pbyMap + nbyMap );
+  }
+  void _Unmap()
+  {
+    if ( !!m_pbyMap )
+    {
+      (void)::munmap( m_pbyMap, m_nbyMap );
+      m_pbyMap = nullptr;
+    }
+  }
+  // The current position has reached the end of the window - move the window to start at the token start.
+  bool _FSlideWindow()
+  {
+    if ( m_nbyMapOffset + m_nbyMap >= m_nbyFileEnd )
+      return false; // eof.
+    size_t nchToken = m_pcCur - m_pcTokenStart;
+    uint64_t nbyTokenStart = _NbyFileFromPc( m_pcTokenStart );
+    _Map( nbyTokenStart, ( nchToken + 1 ) * sizeof( _TyChar ) );
+    m_pcCur = m_pcTokenStart + nchToken;
+    return m_pcCur != m_pcEnd;
+  }
+  // Release the pages of the window that are wholly before the token start.
+  void _ReleaseConsumed()
+  {
+    size_t nbyConsumed = (const uint8_t *)m_pcTokenStart - m_pbyMap;
+    nbyConsumed -= nbyConsumed % _NbyPage();
+    if ( nbyConsumed >= m_nbyReleased + vknbyTransportMappedReleaseSize )
+    {
+      (void)::madvise( m_pbyMap + m_nbyReleased, nbyConsumed - m_nbyReleased, MADV_DONTNEED );
+      m_nbyReleased = nbyConsumed;
+    }
+  }
+  uint64_t _NbyFileFromPc( const _TyChar * _pc ) const
+  {
+    return m_nbyMapOffset + ( (const uint8_t *)_pc - m_pbyMap );
+  }
+  vtyDataPosition _PosFromPc( const _TyChar * _pc ) const
+  {
+    return ( _NbyFileFromPc( _pc ) - m_nbyFileBegin ) / sizeof( _TyChar );
+  }
+  // Positions passed to us are within the current token - and so within the window.
+  const _TyChar * _PcFromPos( vtyDataPosition _pos ) const
+  {
+    Assert( _pos >= PosTokenStart() );
+    Assert( _pos <= PosCurrent() );
+    return m_pcTokenStart + size_t( _pos - PosTokenStart() );
+  }
+  void _GetRangeString( vtyDataPosition _posBegin, vtyDataPosition _posEnd, basic_string< _TyChar > & _rstr ) const
+  {
+    _rstr.assign( _PcFromPos( _posBegin ), size_t( _posEnd - _posBegin ) );
+    if ( s_kfSwitchEndian && _rstr.length() )
+      SwitchEndian( &_rstr[0], _rstr.length() );
+  }
+  void _AssertValidRange( vtyDataPosition _posBegin, vtyDataPosition _posEnd ) const
+  {
+#if ASSERTSENABLED
+    Assert( _posEnd >= _posBegin );
+    Assert( _posBegin >= PosTokenStart() );
+    Assert( _posEnd <= PosCurrent() );
+#endif //ASSERTSENABLED
+  }
+  FileObj m_file;
+  uint64_t m_nbyFileBegin{0}; // The offset of position 0.
+  uint64_t m_nbyFileEnd{0};
+  size_t m_nbyWindow{0};
+  uint8_t * m_pbyMap{nullptr};
+  uint64_t m_nbyMapOffset{0}; // The file offset of m_pbyMap.
+  size_t m_nbyMap{0};
+  size_t m_nbyReleased{0}; // The bytes at the start of the window that we have released.
+  const _TyChar * m_pcTokenStart{nullptr};
+  const _TyChar * m_pcCur{nullptr};
+  const _TyChar * m_pcEnd{nullptr};
+};
+
+__LEXOBJ_END_NAMESPACE
+
+#endif //!WIN32
@@ -0,0 +1,298 @@
+#pragma once
+
+//          Copyright David Lawrence Bien 1997 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt).
+
+// _l_trzip.h
+// Decompressing transports for the lexical analyzer.
+// dbien
+// 19OCT2026
+
+// _l_transport_decompress reads a compressed file descriptor and decompresses it directly into the refcounted blocks of
+//  _l_transport_block - there is no temporary file or buffer holding the whole decompressed input. Positions are in
+//  decompressed characters, exactly as if the decompressed data had been read by _l_transport_file_chunked.
+// Support for each format is optional at build time:
+//  LXOBJ_ZLIB : _l_transport_gzip - gzip or zlib streams ( link with -lz ). Concatenated gzip members are read as one stream.
+//  LXOBJ_ZSTD : _l_transport_zstd - zstd frames ( link with -lzstd ).
+// A decoder provides:
+//  size_t NDecode( const uint8_t *& _rpbyIn, size_t & _rnbyIn, uint8_t * _pbyOut, size_t _nbyOut ) : Decode from the input
+//    into _pbyOut, advancing the input past what was consumed. Returns the number of bytes output.
+//  bool FAtFrameEnd() const : Whether the input consumed so far ends at the end of a complete stream.
+
+#ifndef WIN32
+
+#ifdef LXOBJ_ZLIB
+#include <zlib.h>
+#endif //LXOBJ_ZLIB
+#ifdef LXOBJ_ZSTD
+#include <zstd.h>
+#endif //LXOBJ_ZSTD
+#include "_l_trblk.h"
+
+__LEXOBJ_BEGIN_NAMESPACE
+
+static const size_t vknbyTransportCompressedReadSize = 64 * 1024;
+
+#ifdef LXOBJ_ZLIB
+// _l_decoder_zlib: Inflate gzip or zlib streams.
+class _l_decoder_zlib
+{
+  typedef _l_decoder_zlib _TyThis;
+public:
+  _l_decoder_zlib()
+    : m_upzs( make_unique< z_stream >() )
+  {
+    // 15 + 32: the largest window and detect a gzip or zlib header.
+    int iResult = inflateInit2( m_upzs.get(), 15 + 32 );
+    if ( Z_OK != iResult )
+    {
+      m_upzs.reset();
+      VerifyThrowSz( false, "inflateInit2() failed: [%d].", iResult );
+    }
+  }
+  ~_l_decoder_zlib()
+  {
+    if ( !!m_upzs )
+      (void)inflateEnd( m_upzs.get() );
+  }
+  _l_decoder_zlib( _l_decoder_zlib const & ) = delete;
+  _l_decoder_zlib & operator =( _l_decoder_zlib const & ) = delete;
+  // The z_stream refers to itself from its internal state so we keep it on the heap.
+  _l_decoder_zlib( _l_decoder_zlib && _rr )
+  {
+    swap( _rr );
+  }
+  _l_decoder_zlib & operator =( _l_decoder_zlib && _rr )
+  {
+    _TyThis acquire( std::move( _rr ) );
+    swap( acquire );
+    return *this;
+  }
+  void swap( _TyThis & _r )
+  {
+    m_upzs.swap( _r.m_upzs );
+    std::swap( m_fAtFrameEnd, _r.m_fAtFrameEnd );
+  }
+  size_t NDecode( const uint8_t *& _rpbyIn, size_t & _rnbyIn, uint8_t * _pbyOut, size_t _nbyOut )
+  {
+    z_stream & rzs = *m_upzs;
+    const uInt kuiMax = (numeric_limits< uInt >::max)();
+    rzs.next_in = const_cast< Bytef * >( _rpbyIn );
+    rzs.avail_in = (uInt)(std::min)( _rnbyIn, (size_t)kuiMax );
+    rzs.next_out = _pbyOut;
+    rzs.avail_out = (uInt)(std::min)( _nbyOut, (size_t)kuiMax );
+    const uInt kuiAvailIn = rzs.avail_in;
+    const uInt kuiAvailOut = rzs.avail_out;
+    int iResult = inflate( &rzs, Z_NO_FLUSH );
+    if ( Z_STREAM_END == iResult )
+    {
+      m_fAtFrameEnd = true;
+      (void)inflateReset( &rzs ); // There may be another gzip member following.
+    }
+    else
+    {
+      VerifyThrowSz( ( Z_OK == iResult ) || ( Z_BUF_ERROR == iResult ), "inflate() failed: [%d] [%s].", iResult, !rzs.msg ? "" : rzs.msg );
+      if ( kuiAvailIn != rzs.avail_in )
+        m_fAtFrameEnd = false;
+    }
+    size_t nbyConsumed = kuiAvailIn - rzs.avail_in;
+    _rpbyIn += nbyConsumed;
+    _rnbyIn -= nbyConsumed;
+    return kuiAvailOut - rzs.avail_out;
+  }
+  bool FAtFrameEnd() const
+  {
+    return m_fAtFrameEnd;
+  }
+protected:
+  unique_ptr< z_stream > m_upzs;
+  bool m_fAtFrameEnd{true}; // Empty input is an empty stream.
+};
+#endif //LXOBJ_ZLIB
+
+#ifdef LXOBJ_ZSTD
+// _l_decoder_zstd: Decompress zstd frames.
+class _l_decoder_zstd
+{
+  typedef _l_decoder_zstd _TyThis;
+public:
+  _l_decoder_zstd()
+    : m_pdctx( ZSTD_createDCtx(), &ZSTD_freeDCtx )
+  {
+    VerifyThrowSz( !!m_pdctx, "ZSTD_createDCtx() failed." );
+  }
+  ~_l_decoder_zstd() = default;
+  _l_decoder_zstd( _l_decoder_zstd const & ) = delete;
+  _l_decoder_zstd & operator =( _l_decoder_zstd const & ) = delete;
+  _l_decoder_zstd( _l_decoder_zstd && ) = default;
+  _l_decoder_zstd & operator =( _l_decoder_zstd && ) = default;
+
+  size_t NDecode( const uint8_t *& _rpbyIn, size_t & _rnbyIn, uint8_t * _pbyOut, size_t _nbyOut )
+  {
+    ZSTD_inBuffer ibIn{ _rpbyIn, _rnbyIn, 0 };
+    ZSTD_outBuffer obOut{ _pbyOut, _nbyOut, 0 };
+    size_t nResult = ZSTD_decompressStream( m_pdctx.get(), &obOut, &ibIn );
+    VerifyThrowSz( !ZSTD_isError( nResult ), "ZSTD_decompressStream() failed: [%s].", ZSTD_getErrorName( nResult ) );
+    if ( !nResult )
+      m_fAtFrameEnd = true; // A frame is complete and flushed.
+    else
+    if ( !!ibIn.pos || !!obOut.pos )
+      m_fAtFrameEnd = false;
+    _rpbyIn += ibIn.pos;
+    _rnbyIn -= ibIn.pos;
+    return obOut.pos;
+  }
+  bool FAtFrameEnd() const
+  {
+    return m_fAtFrameEnd;
+  }
+protected:
+  unique_ptr< ZSTD_DCtx, size_t (*)( ZSTD_DCtx * ) > m_pdctx;
+  bool m_fAtFrameEnd{true}; // Empty input has no frames.
+};
+#endif //LXOBJ_ZSTD
+
+// _l_read_source_decompress: Read a compressed file descriptor sequentially and decode it into the blocks. Each block is
+//  filled unless the decompressed input ends. Offsets are in decompressed bytes.
+template < class t_TyDecoder >
+class _l_read_source_decompress
+{
+  typedef _l_read_source_decompress _TyThis;
+public:
+  typedef t_TyDecoder _TyDecoder;
+
+  _l_read_source_decompress() = default;
+  _l_read_source_decompress( _l_read_source_decompress const & ) = delete;
+  _l_read_source_decompress & operator =( _l_read_source_decompress const & ) = delete;
+  _l_read_source_decompress( _l_read_source_decompress && ) = default;
+  _l_read_source_decompress & operator =( _l_read_source_decompress && ) = default;
+
+  void Init( vtyFileHandle _hFile, size_t _nbyRead )
+  {
+    m_hFile = _hFile;
+    m_nbyInCapacity = (std::max)( _nbyRead, size_t( 1 ) );
+    m_rgbyIn = make_unique< uint8_t[] >( m_nbyInCapacity );
+    m_pbyIn = m_rgbyIn.get();
+    m_nbyIn = 0;
+    m_nbyOutput = 0;
+    m_fInputEof = false;
+    m_fEof = false;
+  }
+  bool FSubmitRead( _l_input_block & _rib )
+  {
+    Assert( !_rib.m_fPending );
+    if ( m_fEof )
+      return false;
+    _rib.m_nbyRequest = _rib.m_nbyCapacity;
+    _rib.m_nbyValid = 0;
+    _rib.m_fPending = true;
+    return true;
+  }
+  // Reads happen in WaitRead() - nothing is in flight.
+  void DrainReads()
+  {
+  }
+  void WaitRead( _l_input_block & _rib )
+  {
+    Assert( _rib.m_fPending );
+    _rib.m_nbyOffset = m_nbyOutput;
+    size_t nbyValid = 0;
+    while ( !m_fEof && ( nbyValid < _rib.m_nbyRequest ) )
+    {
+      if ( !m_nbyIn && !m_fInputEof )
+      {
+        m_pbyIn = m_rgbyIn.get();
+        m_nbyIn = _l_read_source_stream::NRead( m_hFile, m_rgbyIn.get(), m_nbyInCapacity );
+        m_fInputEof = m_nbyIn < m_nbyInCapacity;
+      }
+      size_t nbyOut = m_decoder.NDecode( m_pbyIn, m_nbyIn, _rib.m_rgby.get() + nbyValid, _rib.m_nbyRequest - nbyValid );
+      nbyValid += nbyOut;
+      if ( !nbyOut && !m_nbyIn && m_fInputEof )
+      {
+        VerifyThrowSz( m_decoder.FAtFrameEnd(), "Compressed input of hFile[0x%zx] is truncated.", (size_t)m_hFile );
+        m_fEof = true;
+      }
+    }
+    _rib.m_nbyValid = nbyValid;
+    m_nbyOutput += nbyValid;
+    _rib.m_fPending = false;
+  }
+protected:
+  _TyDecoder m_decoder;
+  unique_ptr< uint8_t[] > m_rgbyIn; // Compressed input.
+  const uint8_t * m_pbyIn{nullptr};
+  size_t m_nbyIn{0}; // Compressed bytes remaining at m_pbyIn.
+  size_t m_nbyInCapacity{0};
+  uint64_t m_nbyOutput{0};
+  vtyFileHandle m_hFile{vkhInvalidFileHandle};
+  bool m_fInputEof{false};
+  bool m_fEof{false};
+};
+
+// _l_transport_decompress:
+// Transport reading a compressed file descriptor - any file, pipe or socket. Tokens reference the decompressed blocks as
+//  for _l_transport_file_chunked.
+template < class t_TyChar, class t_TyDecoder, class t_TyBoolSwitchEndian >
+class _l_transport_decompress : public _l_transport_block< t_TyChar, _l_read_source_decompress< t_TyDecoder >, t_TyBoolSwitchEndian >
+{
+  typedef _l_transport_decompress _TyThis;
+  typedef _l_transport_block< t_TyChar, _l_read_source_decompress< t_TyDecoder >, t_TyBoolSwitchEndian > _TyBase;
+public:
+  using typename _TyBase::_TyChar;
+
+  _l_transport_decompress() = delete;
+  _l_transport_decompress( _l_transport_decompress const & ) = delete;
+  _l_transport_decompress & operator =( _l_transport_decompress const & ) = delete;
+  _l_transport_decompress( _l_transport_decompress && ) = default;
+  _l_transport_decompress & operator =( _l_transport_decompress && ) = default;
+
+  _l_transport_decompress( const char * _pszFileName, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    PrepareErrNo();
+    vtyFileHandle hFile = OpenReadOnlyFile( _pszFileName );
+    if ( vkhInvalidFileHandle == hFile )
+      THROWNAMEDEXCEPTIONERRNO( GetLastErrNo(), "Open of [%s] failed.", _pszFileName );
+    m_file.SetHFile( hFile, true );
+    _Init();
+  }
+  // We read starting at the current seek position of the file.
+  _l_transport_decompress( FileObj & _rfoFile, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead )
+  {
+    VerifyThrowSz( _rfoFile.FIsOpen(), "Caller should pass an open file..." );
+    m_file = std::move( _rfoFile );
+    _Init();
+  }
+  // Attach to an hFile like STDIN - in which case you would set _fOwnFd to false.
+  _l_transport_decompress( vtyFileHandle _hFile, bool _fOwnFd = false, size_t _nbyBlock = vknbyTransportBlockSize, size_t _nBlocksAhead = vknTransportBlocksAhead )
+    : _TyBase( _nbyBlock, _nBlocksAhead ),
+      m_file( _hFile, _fOwnFd )
+  {
+    _Init();
+  }
+protected:
+  using _TyBase::m_source;
+  void _Init()
+  {
+    (void)posix_fadvise( m_file.HFileGet(), 0, 0, POSIX_FADV_SEQUENTIAL ); // Fails harmlessly for pipes.
+    m_source.Init( m_file.HFileGet(), vknbyTransportCompressedReadSize );
+    _TyBase::_Start();
+  }
+  FileObj m_file;
+};
+
+#ifdef LXOBJ_ZLIB
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+using _l_transport_gzip = _l_transport_decompress< t_TyChar, _l_decoder_zlib, t_TyBoolSwitchEndian >;
+#endif //LXOBJ_ZLIB
+#ifdef LXOBJ_ZSTD
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+using _l_transport_zstd = _l_transport_decompress< t_TyChar, _l_decoder_zstd, t_TyBoolSwitchEndian >;
+#endif //LXOBJ_ZSTD
+
+__LEXOBJ_END_NAMESPACE
+
+#endif //!WIN32
@@ -92,7 +92,7 @@ struct _l_state_proto;
 template <class t_TyChar>
 struct _l_an_mostbase;
 
-template <class t_TyTraits, bool t_fSupportLookahead, bool t_fSupportTriggers, bool t_fTrace = false>
+template <class t_TyTraits, bool t_fSupportLookahead, bool t_fSupportTriggers, bool t_fTrace = false, class t_TyCompactStateIndex = void, bool t_fNulIsCharacter = false, bool t_fDefaultTransitions = false>
 struct _l_analyzer;
 
 template <class t_TyChar, int t_iTransitions,
@@ -104,6 +104,14 @@ struct _l_state;
 template <class t_TyChar>
 struct _l_transition;
 
+// _l_cmptb.h:
+template < class t_TyChar, class t_TyStateIndex >
+struct _l_compact_transition;
+template < class t_TyStateIndex >
+struct _l_compact_state;
+template < class t_TyChar, class t_TyStateIndex >
+struct _l_compact_tables;
+
 // _l_data.h:
 class _l_data_range;
 class _l_data_typed_range;
@@ -139,6 +147,30 @@ template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
 class _l_transport_fixedmem;
 template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
 class _l_transport_mapped;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_fixedmem_sentinel;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_mapped_sentinel;
+template < class t_TyChar, class t_TySource, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_block;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_readahead;
+template < class t_TyChar >
+class _l_transport_chunk_ctxt;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_file_chunked;
+template < class t_TyChar, class t_TyDecoder, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_decompress;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_segmented;
+template < class t_TyChar >
+class _l_transport_utf8;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_mapped_window;
+template < class t_TyTransportCtxt >
+class _l_transport_document_ctxt;
+template < class t_TyChar, class t_TyBoolSwitchEndian = false_type >
+class _l_transport_batch;
 template < class t_TyVariant >
 class _l_transport_var_ctxt;
 template < class ... t_TysTransports >
@@ -174,4 +206,37 @@ struct TFIsTransportVar< _l_transport_var< t_tys ... > >
 template < class t_TyTransport >
 inline constexpr bool TFIsTransportVar_v = TFIsTransportVar< t_TyTransport >::value;
 
+// TFIsTransportBatch:
+template < class t_ty >
+struct TFIsTransportBatch
+{
+  static constexpr bool value = false;  
+};
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+struct TFIsTransportBatch< _l_transport_batch< t_TyChar, t_TyBoolSwitchEndian > >
+{
+  static constexpr bool value = true;  
+};
+template < class t_TyTransport >
+inline constexpr bool TFIsTransportBatch_v = TFIsTransportBatch< t_TyTransport >::value;
+
+// TFIsTransportSentinel:
+template < class t_TyTransport >
+struct TFIsTransportSentinel
+{
+  static constexpr bool value = false;  
+};
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+struct TFIsTransportSentinel< _l_transport_fixedmem_sentinel< t_TyChar, t_TyBoolSwitchEndian > >
+{
+  static constexpr bool value = true;  
+};
+template < class t_TyChar, class t_TyBoolSwitchEndian >
+struct TFIsTransportSentinel< _l_transport_mapped_sentinel< t_TyChar, t_TyBoolSwitchEndian > >
+{
+  static constexpr bool value = true;  
+};
+template < class t_TyTransport >
+inline constexpr bool TFIsTransportSentinel_v = TFIsTransportSentinel< t_TyTransport >::value;
+
 __LEXOBJ_END_NAMESPACE